@@ -3,10 +3,13 @@
 #include <deque>
 #include <array>
 #include "my_list.h"
+#include "my_unrolled_list.h"
+#include "my_intrusive_list.h"
 #include "my_vector.h"
 #include "my_allocator.h"
 #include "my_iterator.h"
-// #include "my_heap.h"
+#include "my_heap.h"
+#include "my_queue.h"
 #include <new>
 #include <vector>
 #include <algorithm>
@@ -16,6 +19,17 @@
 #include <iterator>
 #include <functional>
 #include "my_algorithm.h"
+#include "my_concurrent_queue.h"
+#include "my_execution.h"
+#include "my_search.h"
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <list>
+#include <queue>
+#include <stdexcept>
+#include <random>
 //#include "my_pair.h"
 using namespace std;
 #define FOO
@@ -52,6 +66,15 @@ void print(const T & val)
 {
 	cout << val << " ";
 }
+
+//返回f运行的毫秒数
+template<typename F>
+double time_ms(F f)
+{
+	auto start_time = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start_time).count();
+}
 // void test_pop_heap()
 // {
 // 	vector<int> vec{1,5,9,3,5,7,8,4,2,6};
@@ -265,6 +288,44 @@ void test_uninitia()
   cout << endl;
 }
 
+//type_traits的各项判断, 1表示走快速路径: 赋值/POD为memmove, 析构平凡时destroy什么也不做
+enum traits_color { red, green };
+struct traits_point { float x, y, z; int id = 0; };
+struct traits_const { const int id; };
+struct traits_named { int id; std::string name; };
+struct traits_owner { int *p; ~traits_owner() { } };
+
+inline int traits_bit(jan::_true_type) { return 1; }
+inline int traits_bit(jan::_false_type) { return 0; }
+
+template <typename T>
+void print_traits(const char *name)
+{
+  typedef jan::type_traits<T> tr;
+  cout << name << "\t" << traits_bit(typename tr::has_trivial_default_constructor())
+       << "\t" << traits_bit(typename tr::has_trivial_copy_constructor())
+       << "\t" << traits_bit(typename tr::has_trivial_assignment_operator())
+       << "\t" << traits_bit(typename tr::has_trivial_destructor())
+       << "\t" << traits_bit(typename tr::is_POD_type())
+       << "\t" << traits_bit(typename jan::is_integer<T>::integral()) << endl;
+}
+
+void test_type_traits()
+{
+  cout << "type\t\tctor\tcopy\tassign\tdtor\tPOD\tinteger" << endl;
+  print_traits<int>("int\t");
+  print_traits<float>("float\t");
+  print_traits<bool>("bool\t");
+  print_traits<unsigned long long>("ull\t");
+  print_traits<char16_t>("char16_t");
+  print_traits<traits_color>("enum\t");
+  print_traits<int *>("int*\t");
+  print_traits<traits_point>("point\t");
+  print_traits<traits_const>("const member");
+  print_traits<traits_named>("std::string");
+  print_traits<traits_owner>("user dtor");
+}
+
 void test_vector()
 {
   jan::vector<int> vec(10,2);
@@ -388,6 +449,1163 @@ void test_my_list()
   // std::for_each(ls.begin(), ls.end(), print<int>);
   // cout << endl;
 }
+
+void test_my_list_time()
+{
+	const int n = 1000000;
+	for (int round = 0; round < 5; ++round)
+	{
+		auto * jan_ls = new jan::list<int>;
+		double jan_build = time_ms([&]{ for (int i = 0; i < n; ++i) jan_ls->push_back(i); });
+		double jan_destroy = time_ms([&]{ delete jan_ls; });
+		auto * std_ls = new list<int>;
+		double std_build = time_ms([&]{ for (int i = 0; i < n; ++i) std_ls->push_back(i); });
+		double std_destroy = time_ms([&]{ delete std_ls; });
+		cout << "jan::list build: " << jan_build << " ms destroy: " << jan_destroy
+			 << " ms | std::list build: " << std_build << " ms destroy: " << std_destroy << " ms" << endl;
+	}
+}
+
+void test_unrolled_list_time()
+{
+	const int n = 10000000;
+	jan::list<int> ls;
+	jan::unrolled_list<int> uls;
+	jan::vector<int> vec;
+	for (int i = 0; i < n; ++i)
+	{
+		ls.push_back(i);
+		uls.push_back(i);
+		vec.push_back(i);
+	}
+	long long sum[3] = {0, 0, 0};
+	cout << "jan::list sum: " << time_ms([&]{ sum[0] = jan::accumulate(ls.begin(), ls.end(), 0LL); }) << " ms" << endl;
+	cout << "jan::unrolled_list sum: " << time_ms([&]{ sum[1] = jan::accumulate(uls.begin(), uls.end(), 0LL); }) << " ms" << endl;
+	cout << "jan::vector sum: " << time_ms([&]{ sum[2] = jan::accumulate(vec.begin(), vec.end(), 0LL); }) << " ms" << endl;
+	cout << sum[0] << " " << sum[1] << " " << sum[2] << endl;
+}
+
+void test_list_sort_time()
+{
+	const int n = 10000000;
+	srand((unsigned)time(0));
+	jan::list<int> ls1, ls2;
+	std::list<int> std_ls;
+	for (int i = 0; i < n; ++i)
+	{
+		int val = rand();
+		ls1.push_back(val);
+		ls2.push_back(val);
+		std_ls.push_back(val);
+	}
+	cout << "jan::list::sort: " << time_ms([&]{ ls1.sort(); }) << " ms" << endl;
+	cout << "std::list::sort: " << time_ms([&]{ std_ls.sort(); }) << " ms" << endl;
+	cout << "copy + std::sort + rebuild: " << time_ms([&]{
+		vector<int> vec(ls2.begin(), ls2.end());
+		std::sort(vec.begin(), vec.end());
+		ls2.clear();
+		for (int val : vec)
+			ls2.push_back(val);
+	}) << " ms" << endl;
+	cout << std::equal(ls1.begin(), ls1.end(), ls2.begin()) << " "
+		 << std::equal(ls1.begin(), ls1.end(), std_ls.begin()) << endl;
+}
+
+//merge中comp抛出异常后两个list缓存的size要和实际的节点数一致
+void test_list_merge_size()
+{
+	jan::list<int> a, b;
+	for (int i = 0; i < 10; ++i)
+	{
+		a.push_back(2 * i);
+		b.push_back(2 * i + 1);
+	}
+	int calls = 0;
+	try {
+		a.merge(b, [&](int x, int y) {
+			if (++calls == 5)
+				throw std::runtime_error("comp");
+			return x < y;
+		});
+	} catch (const std::runtime_error &) {
+	}
+	cout << "a: size " << a.size() << ", nodes " << std::distance(a.begin(), a.end()) << endl;
+	cout << "b: size " << b.size() << ", nodes " << std::distance(b.begin(), b.end()) << endl;
+}
+
+//定时器队列: 小根堆里有timers个到期时间, 每次取出最早的一个再加上随机间隔放回去
+template<size_t D>
+double timer_queue_time(const vector<unsigned long long> &init, const vector<unsigned> &delay, unsigned long long &check)
+{
+	vector<unsigned long long> heap(init);
+	jan::greater<unsigned long long> comp;
+	return time_ms([&]{
+		jan::make_heap<D>(heap.begin(), heap.end(), comp);
+		for (size_t i = 0; i < delay.size(); ++i)
+		{
+			jan::pop_heap<D>(heap.begin(), heap.end(), comp);
+			heap.back() += delay[i];
+			jan::push_heap<D>(heap.begin(), heap.end(), comp);
+		}
+		check = heap.front();
+	});
+}
+
+//同样的定时器队列, 用std::pop_heap/push_heap作对照
+double std_timer_queue_time(const vector<unsigned long long> &init, const vector<unsigned> &delay, unsigned long long &check)
+{
+	vector<unsigned long long> heap(init);
+	std::greater<unsigned long long> comp;
+	return time_ms([&]{
+		std::make_heap(heap.begin(), heap.end(), comp);
+		for (size_t i = 0; i < delay.size(); ++i)
+		{
+			std::pop_heap(heap.begin(), heap.end(), comp);
+			heap.back() += delay[i];
+			std::push_heap(heap.begin(), heap.end(), comp);
+		}
+		check = heap.front();
+	});
+}
+
+void test_heap_time()
+{
+	const int timers = 1 << 20;
+	const int n = 10000000;
+	srand((unsigned)time(0));
+	vector<unsigned long long> init(timers);
+	vector<unsigned> delay(n);
+	for (auto &t : init)
+		t = rand() % 1000000;
+	for (auto &d : delay)
+		d = rand() % 1000000;
+	unsigned long long check[4];
+	cout << "std::pop_heap/push_heap: " << std_timer_queue_time(init, delay, check[3]) << " ms" << endl;
+	cout << "2-ary heap: " << timer_queue_time<2>(init, delay, check[0]) << " ms" << endl;
+	cout << "4-ary heap: " << timer_queue_time<4>(init, delay, check[1]) << " ms" << endl;
+	cout << "8-ary heap: " << timer_queue_time<8>(init, delay, check[2]) << " ms" << endl;
+	cout << check[0] << " " << check[1] << " " << check[2] << " " << check[3] << endl;
+}
+
+//随机图上的Dijkstra: 索引堆用decrease_key, std::priority_queue重复入队并跳过过期的元素
+template<size_t D>
+double dijkstra_indexed_time(const vector<int> &head, const vector<int> &to, const vector<int> &w, vector<long long> &dist)
+{
+	const int n = head.size() - 1;
+	return time_ms([&]{
+		dist.assign(n, -1);
+		vector<size_t> handle(n);
+		vector<bool> queued(n, false);
+		jan::indexed_heap<pair<long long, int>, D, jan::greater<pair<long long, int>>> heap;
+		handle[0] = heap.push(make_pair(0LL, 0));
+		queued[0] = true;
+		while (!heap.empty())
+		{
+			long long d = heap.top().first;
+			int u = heap.top().second;
+			heap.pop();
+			dist[u] = d;
+			for (int e = head[u]; e < head[u + 1]; ++e)
+			{
+				int v = to[e];
+				long long nd = d + w[e];
+				if (dist[v] >= 0)
+					continue;
+				if (!queued[v])
+				{
+					handle[v] = heap.push(make_pair(nd, v));
+					queued[v] = true;
+				}
+				else if (nd < heap.value(handle[v]).first)
+					heap.decrease_key(handle[v], make_pair(nd, v));
+			}
+		}
+	});
+}
+
+void test_dijkstra_time()
+{
+	const int n = 1000000, degree = 8;
+	srand((unsigned)time(0));
+	vector<int> head(n + 1), to, w;
+	for (int u = 0; u < n; ++u)
+	{
+		head[u] = to.size();
+		to.push_back((u + 1) % n);
+		w.push_back(rand() % 1000 + 1);
+		for (int i = 1; i < degree; ++i)
+		{
+			to.push_back(rand() % n);
+			w.push_back(rand() % 1000 + 1);
+		}
+	}
+	head[n] = to.size();
+
+	vector<long long> dist_std(n, -1), dist2, dist4;
+	cout << "std::priority_queue (lazy): " << time_ms([&]{
+		std::priority_queue<pair<long long, int>, vector<pair<long long, int>>, std::greater<pair<long long, int>>> pq;
+		pq.push(make_pair(0LL, 0));
+		while (!pq.empty())
+		{
+			long long d = pq.top().first;
+			int u = pq.top().second;
+			pq.pop();
+			if (dist_std[u] >= 0)
+				continue;
+			dist_std[u] = d;
+			for (int e = head[u]; e < head[u + 1]; ++e)
+				if (dist_std[to[e]] < 0)
+					pq.push(make_pair(d + w[e], to[e]));
+		}
+	}) << " ms" << endl;
+	cout << "jan::indexed_heap<2>: " << dijkstra_indexed_time<2>(head, to, w, dist2) << " ms" << endl;
+	cout << "jan::indexed_heap<4>: " << dijkstra_indexed_time<4>(head, to, w, dist4) << " ms" << endl;
+	cout << (dist_std == dist2) << " " << (dist_std == dist4) << endl;
+}
+
+//同一份数据分别交给jan::sort和std::sort, 打印两者的耗时
+template<typename T>
+void compare_sort(const char *name, const vector<T> &data)
+{
+	vector<T> a(data), b(data);
+	double jan_ms = time_ms([&]{ jan::sort(a.begin(), a.end()); });
+	double std_ms = time_ms([&]{ std::sort(b.begin(), b.end()); });
+	cout << name << "  jan::sort: " << jan_ms << " ms  std::sort: " << std_ms << " ms  " << (a == b) << endl;
+}
+
+void test_sort_time()
+{
+	const int n = 10000000;
+	srand((unsigned)time(0));
+	vector<int> random(n), sorted(n), reversed(n), few(n), pipe(n);
+	for (int i = 0; i < n; ++i)
+	{
+		random[i] = rand();
+		sorted[i] = i;
+		reversed[i] = n - i;
+		few[i] = rand() % 16;
+		pipe[i] = i < n / 2 ? i : n - i;
+	}
+	compare_sort("random int  ", random);
+	compare_sort("sorted int  ", sorted);
+	compare_sort("reversed int", reversed);
+	compare_sort("16 distinct ", few);
+	compare_sort("organ pipe  ", pipe);
+	vector<double> dbl(n);
+	for (auto &d : dbl)
+		d = rand() / (double)RAND_MAX;
+	compare_sort("random double", dbl);
+	vector<string> str(1000000);
+	for (auto &s : str)
+		s = to_string(rand());
+	compare_sort("random string", str);
+}
+
+template<typename T>
+void compare_stable_sort(const char *name, const vector<T> &data)
+{
+	vector<T> a(data), b(data), c(data), buf(data.size() / 8);
+	double jan_ms = time_ms([&]{ jan::stable_sort(a.begin(), a.end()); });
+	double std_ms = time_ms([&]{ std::stable_sort(b.begin(), b.end()); });
+	double small_ms = time_ms([&]{ jan::stable_sort(c.begin(), c.end(), jan::less<T>(), buf.data(), buf.size()); });
+	cout << name << "  jan::stable_sort: " << jan_ms << " ms  n/8 buffer: " << small_ms
+		 << " ms  std::stable_sort: " << std_ms << " ms  " << (a == b && c == b) << endl;
+}
+
+void test_stable_sort_time()
+{
+	const int n = 10000000;
+	srand((unsigned)time(0));
+	vector<int> random(n), sorted(n), reversed(n), mostly(n), appended(n);
+	for (int i = 0; i < n; ++i)
+	{
+		random[i] = rand();
+		sorted[i] = i;
+		reversed[i] = n - i;
+		mostly[i] = i;
+		appended[i] = i < n - n / 100 ? i : rand() % n;
+	}
+	//1%的位置被随机交换
+	for (int i = 0; i < n / 100; ++i)
+		swap(mostly[rand() % n], mostly[rand() % n]);
+	compare_stable_sort("random      ", random);
+	compare_stable_sort("sorted      ", sorted);
+	compare_stable_sort("reversed    ", reversed);
+	compare_stable_sort("1% swapped  ", mostly);
+	compare_stable_sort("1% appended ", appended);
+}
+
+struct sort_record
+{
+	unsigned int key;
+	unsigned int payload[3];
+};
+
+void test_radix_sort_time()
+{
+	const int n = 10000000;
+	srand((unsigned)time(0));
+	jan::vector<unsigned long long> u64(n, 0);
+	for (int i = 0; i < n; ++i)
+		u64[i] = ((unsigned long long)rand() << 33) ^ ((unsigned long long)rand() << 11) ^ rand();
+	jan::vector<unsigned long long> a(u64), b(u64), c(u64), small(u64);
+	for (int i = 0; i < n; ++i)
+		small[i] = u64[i] % 100000;
+	cout << "uint64 radix_sort: " << time_ms([&]{ jan::radix_sort(a.begin(), a.end()); }) << " ms  "
+		 << "jan::sort: " << time_ms([&]{ jan::sort(b.begin(), b.end()); }) << " ms  "
+		 << std::equal(a.begin(), a.end(), b.begin()) << endl;
+	cout << "uint64 std::sort: " << time_ms([&]{ std::sort(c.begin(), c.end()); }) << " ms" << endl;
+	cout << "uint64 < 100000 radix_sort (3 of 8 passes): " << time_ms([&]{ jan::radix_sort(small.begin(), small.end()); }) << " ms" << endl;
+
+	vector<int> i32(n), i32_std;
+	for (auto &v : i32)
+		v = rand() - RAND_MAX / 2;
+	i32_std = i32;
+	cout << "int32 auto_sort: " << time_ms([&]{ jan::auto_sort(i32.begin(), i32.end()); }) << " ms  "
+		 << "std::sort: " << time_ms([&]{ std::sort(i32_std.begin(), i32_std.end()); }) << " ms  " << (i32 == i32_std) << endl;
+
+	vector<double> dbl(n), dbl_std;
+	for (auto &v : dbl)
+		v = (rand() - RAND_MAX / 2) / 1000.0;
+	dbl_std = dbl;
+	cout << "double radix_sort: " << time_ms([&]{ jan::radix_sort(dbl.begin(), dbl.end()); }) << " ms  "
+		 << "std::sort: " << time_ms([&]{ std::sort(dbl_std.begin(), dbl_std.end()); }) << " ms  " << (dbl == dbl_std) << endl;
+
+	vector<sort_record> rec(n), rec_std;
+	for (auto &r : rec)
+		r.key = rand();
+	rec_std = rec;
+	cout << "16-byte record radix_sort by key: "
+		 << time_ms([&]{ jan::radix_sort(rec.begin(), rec.end(), [](const sort_record &r){ return r.key; }); }) << " ms  "
+		 << "std::stable_sort: "
+		 << time_ms([&]{ std::stable_sort(rec_std.begin(), rec_std.end(), [](const sort_record &a, const sort_record &b){ return a.key < b.key; }); })
+		 << " ms" << endl;
+}
+
+volatile double simd_sink;
+
+//f执行reps次, 每次读bytes字节, 返回GB/s
+template <typename F>
+double gb_per_s(size_t bytes, int reps, F f)
+{
+	double ms = time_ms([&]{ for (int r = 0; r < reps; ++r) f(); });
+	return bytes * (double)reps / ms / 1e6;
+}
+
+//n个T上find(找不到), count, accumulate, inner_product在普通循环和各指令集核心下的速度
+template <typename T>
+void simd_bench(const char *type, size_t n, int reps)
+{
+	vector<T> a(n), b(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		a[i] = T(i % 7);
+		b[i] = T(i % 5);
+	}
+	const T *p = a.data(), *q = b.data();
+	const T miss = T(-1);
+	vector<jan::__simd_kernel_table<T>> tables;
+	tables.push_back(jan::__simd_make_table<jan::__simd_sse2, jan::__sse2_ops<T>>("sse2"));
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		tables.push_back(jan::__simd_make_table<jan::__simd_avx2, jan::__avx2_ops<T>>("avx2"));
+	if (__builtin_cpu_supports("avx512f"))
+		tables.push_back(jan::__simd_make_table<jan::__simd_avx512, jan::__avx512_ops<T>>("avx512"));
+
+	const size_t bytes = n * sizeof(T);
+	cout << type << " x " << n << " (GB/s)\tscalar";
+	for (auto &t : tables)
+		cout << "\t" << t.isa;
+	cout << endl;
+	cout << "  find\t\t" << gb_per_s(bytes, reps, [&]{ simd_sink = jan::__find(p, p + n, miss, jan::_false_type()) - p; });
+	for (auto &t : tables)
+		cout << "\t" << gb_per_s(bytes, reps, [&]{ simd_sink = t.find(p, p + n, miss) - p; });
+	cout << endl << "  count\t\t" << gb_per_s(bytes, reps, [&]{ simd_sink = jan::__count(p, p + n, T(3), jan::_false_type()); });
+	for (auto &t : tables)
+		cout << "\t" << gb_per_s(bytes, reps, [&]{ simd_sink = t.count(p, p + n, T(3)); });
+	cout << endl << "  accumulate\t" << gb_per_s(bytes, reps, [&]{ simd_sink = jan::__accumulate(p, p + n, T(0), jan::_false_type()); });
+	for (auto &t : tables)
+		cout << "\t" << gb_per_s(bytes, reps, [&]{ simd_sink = t.sum(p, p + n); });
+	cout << endl << "  inner_product\t" << gb_per_s(2 * bytes, reps, [&]{ simd_sink = jan::__inner_product(p, p + n, q, T(0), jan::_false_type()); });
+	for (auto &t : tables)
+		cout << "\t" << gb_per_s(2 * bytes, reps, [&]{ simd_sink = t.dot(p, p + n, q); });
+	cout << endl;
+}
+
+void test_simd_time()
+{
+	cout << "dispatched to " << jan::__simd_table<float>().isa << endl;
+	//16K个元素在L1/L2中, 16M个元素需要从内存读
+	simd_bench<int>("int", 1 << 14, 20000);
+	simd_bench<float>("float", 1 << 14, 20000);
+	simd_bench<double>("double", 1 << 14, 20000);
+	simd_bench<int>("int", 1 << 24, 20);
+	simd_bench<float>("float", 1 << 24, 20);
+	simd_bench<double>("double", 1 << 24, 20);
+}
+
+//读一遍hot, 返回毫秒数; 大块拷贝/填充之后再读, 可以看出hot有多少被挤出了缓存
+double rescan_ms(const vector<int> &hot)
+{
+	return time_ms([&]{ simd_sink = jan::accumulate(hot.data(), hot.data() + hot.size(), 0); });
+}
+
+//bytes字节的int区间上, 原来的memmove/逐个赋值与新的copy/fill的速度(GB/s)
+void stream_bench(size_t bytes, int reps, vector<int> &hot)
+{
+	const size_t n = bytes / sizeof(int);
+	vector<int> src(n, 1), dst(n, 0);
+	int *s = src.data(), *d = dst.data();
+	double hot_old, hot_new;
+	cout << bytes << " bytes (GB/s)" << endl;
+	cout << "  copy  memmove: " << gb_per_s(bytes, reps, [&]{ memmove(d, s, bytes); simd_sink = d[n / 2]; });
+	rescan_ms(hot);
+	memmove(d, s, bytes);
+	hot_old = rescan_ms(hot);
+	cout << "  jan::copy: " << gb_per_s(bytes, reps, [&]{ jan::copy(s, s + n, d); simd_sink = d[n / 2]; });
+	rescan_ms(hot);
+	jan::copy(s, s + n, d);
+	hot_new = rescan_ms(hot);
+	cout << "  (hot set rescan after: " << hot_old << " / " << hot_new << " ms)" << endl;
+
+	cout << "  fill  loop: " << gb_per_s(bytes, reps, [&]{ jan::__fill(d, d + n, 0x01020304, jan::_false_type()); simd_sink = d[n / 2]; });
+	rescan_ms(hot);
+	jan::__fill(d, d + n, 0x01020304, jan::_false_type());
+	hot_old = rescan_ms(hot);
+	cout << "  jan::fill: " << gb_per_s(bytes, reps, [&]{ jan::fill(d, d + n, 0x01020304); simd_sink = d[n / 2]; });
+	rescan_ms(hot);
+	jan::fill(d, d + n, 0x01020304);
+	hot_new = rescan_ms(hot);
+	cout << "  (hot set rescan after: " << hot_old << " / " << hot_new << " ms)" << endl;
+
+	cout << "  fill0 loop: " << gb_per_s(bytes, reps, [&]{ jan::__fill_n(d, n, 0, jan::_false_type()); simd_sink = d[n / 2]; })
+		 << "  jan::fill_n: " << gb_per_s(bytes, reps, [&]{ jan::fill_n(d, n, 0); simd_sink = d[n / 2]; }) << endl;
+}
+
+void test_stream_time()
+{
+	cout << "streaming threshold: " << jan::streaming_threshold() << " bytes" << endl;
+	//hot是需要留在缓存里的4MB工作集
+	vector<int> hot((4 << 20) / sizeof(int), 1);
+	stream_bench(1 << 10, 1000000, hot);
+	stream_bench(1 << 20, 2000, hot);
+	stream_bench(1 << 30, 3, hot);
+}
+
+//从[0,range)中随机取n个不同的数, 升序排列
+template <typename T>
+vector<T> sorted_unique_sample(size_t n, unsigned long long range, std::mt19937_64 &rng)
+{
+	vector<T> v(n);
+	for (auto &x : v)
+		x = T(rng() % range);
+	std::sort(v.begin(), v.end());
+	v.erase(std::unique(v.begin(), v.end()), v.end());
+	return v;
+}
+
+//a, b上集合算法原来的逐个归并与倍增查找/SIMD块比较的耗时(毫秒, 取reps次的平均)
+template <typename T>
+void set_bench(const char *name, const vector<T> &a, const vector<T> &b, int reps)
+{
+	vector<T> out(a.size() + b.size());
+	auto avg = [&](std::function<T *()> f) {
+		T *e = nullptr;
+		double ms = time_ms([&]{ for (int r = 0; r < reps; ++r) e = f(); }) / reps;
+		simd_sink = e - out.data();
+		return ms;
+	};
+	const T *a0 = a.data(), *a1 = a0 + a.size(), *b0 = b.data(), *b1 = b0 + b.size();
+	T *o = out.data();
+	jan::less<T> comp;
+	cout << name << " (" << a.size() << " vs " << b.size() << ", ms)" << endl;
+	cout << "  intersection  merge " << avg([&]{ return jan::__set_intersection(a0, a1, b0, b1, o, comp, jan::input_iterator_tag()); })
+		 << "  jan " << avg([&]{ return jan::set_intersection(a0, a1, b0, b1, o); })
+		 << "  sorted_unique " << avg([&]{ return jan::set_intersection(jan::sorted_unique, a0, a1, b0, b1, o); })
+		 << "  std " << avg([&]{ return std::set_intersection(a0, a1, b0, b1, o); }) << endl;
+	cout << "  difference    merge " << avg([&]{ return jan::__set_difference(a0, a1, b0, b1, o, comp, jan::input_iterator_tag()); })
+		 << "  jan " << avg([&]{ return jan::set_difference(a0, a1, b0, b1, o); })
+		 << "  std " << avg([&]{ return std::set_difference(a0, a1, b0, b1, o); }) << endl;
+	cout << "  union         merge " << avg([&]{ return jan::__set_union(a0, a1, b0, b1, o, comp, jan::input_iterator_tag()); })
+		 << "  jan " << avg([&]{ return jan::set_union(a0, a1, b0, b1, o); })
+		 << "  std " << avg([&]{ return std::set_union(a0, a1, b0, b1, o); }) << endl;
+}
+
+void test_set_time()
+{
+	std::mt19937_64 rng(42);
+	//倒排表: 1k个与10M个文档号求交
+	auto small = sorted_unique_sample<unsigned>(1000, 100000000, rng);
+	auto big = sorted_unique_sample<unsigned>(10000000, 100000000, rng);
+	set_bench("uint32 skewed", small, big, 10);
+	set_bench("uint32 skewed (reversed)", big, small, 10);
+	auto a = sorted_unique_sample<unsigned>(1000000, 2000000, rng);
+	auto b = sorted_unique_sample<unsigned>(1000000, 2000000, rng);
+	set_bench("uint32 balanced", a, b, 10);
+	auto a64 = sorted_unique_sample<unsigned long long>(1000000, 2000000, rng);
+	auto b64 = sorted_unique_sample<unsigned long long>(1000000, 2000000, rng);
+	set_bench("uint64 balanced", a64, b64, 10);
+	auto c = sorted_unique_sample<unsigned>(1000000, 100000000, rng);
+	set_bench("uint32 1:10", c, sorted_unique_sample<unsigned>(10000000, 100000000, rng), 3);
+}
+
+//n个元素的有序表上随机查找: 原来的二分, 无分支二分, Eytzinger布局, B+布局(每次查找的纳秒数)
+void test_search_time()
+{
+	for (size_t n : {(size_t)1 << 16, (size_t)1 << 22, (size_t)100000000})
+	{
+		jan::vector<unsigned> table(n, 0u);
+		for (size_t i = 0; i < n; ++i)
+			table[i] = (unsigned)(i * 3);
+		const size_t q = 4000000;
+		vector<unsigned> queries(q);
+		std::mt19937 rng(5);
+		for (auto &x : queries)
+			x = rng() % (3 * n);
+		jan::eytzinger_array<unsigned> eyt(table);
+		jan::bplus_array<unsigned> bpt(table);
+		const unsigned *b = table.begin(), *e = table.end();
+		size_t sink = 0;
+		auto per_query = [&](std::function<void()> f) { return time_ms(f) * 1e6 / q; };
+		cout << n << " uint32, ns per lookup" << endl;
+		cout << "  forward binary search  " << per_query([&]{ for (unsigned x : queries) sink += jan::__lower_bound(b, e, x, jan::less<unsigned>(), jan::forward_iterator_tag()) - b; }) << endl;
+		cout << "  branchless lower_bound " << per_query([&]{ for (unsigned x : queries) sink += jan::lower_bound(b, e, x) - b; }) << endl;
+		cout << "  std::lower_bound       " << per_query([&]{ for (unsigned x : queries) sink += std::lower_bound(b, e, x) - b; }) << endl;
+		cout << "  eytzinger_array        " << per_query([&]{ for (unsigned x : queries) { const unsigned *p = eyt.lower_bound(x); sink += p ? *p : 0; } }) << endl;
+		cout << "  bplus_array            " << per_query([&]{ for (unsigned x : queries) sink += bpt.lower_bound(x); }) << endl;
+		simd_sink = (double)sink;
+	}
+}
+
+//n个随机数中取最小的k个并排好序: 整体排序, partial_sort, nth_element后排序前k个, 流式top_k
+void test_select_time()
+{
+	const size_t n = 1 << 24;
+	vector<unsigned> src(n), work(n);
+	std::mt19937 rng(11);
+	for (auto &x : src)
+		x = rng();
+	//每次计时前恢复原始数据, 拷贝不计入耗时
+	auto run = [&](const char *name, size_t k, std::function<void()> f) {
+		std::copy(src.begin(), src.end(), work.begin());
+		double ms = time_ms(f);
+		cout << "  " << name << ": " << ms << " ms  k-th " << work[k - 1] << endl;
+	};
+	for (size_t k : {(size_t)10, (size_t)1000})
+	{
+		cout << n << " uint32, k = " << k << endl;
+		unsigned *b = work.data(), *e = b + n;
+		run("jan::sort           ", k, [&]{ jan::sort(b, e); });
+		run("jan::partial_sort   ", k, [&]{ jan::partial_sort(b, b + k, e); });
+		run("jan::nth_element    ", k, [&]{ jan::nth_element(b, b + k - 1, e); jan::sort(b, b + k); });
+		run("jan::top_k (greater)", k, [&]{
+			jan::top_k<unsigned, jan::greater<unsigned>> top(k);
+			top.push_range(src.begin(), src.end());
+			top.copy_sorted(work.begin());
+		});
+		run("std::partial_sort   ", k, [&]{ std::partial_sort(b, b + k, e); });
+		run("std::nth_element    ", k, [&]{ std::nth_element(b, b + k - 1, e); std::sort(b, b + k); });
+	}
+}
+
+//把约1<<24个uint32分成k个有序段做k路归并: 败者树, 批量追加到jan::vector, 二叉堆, 以及两两链式归并(只测小k)
+void test_merge_k_time()
+{
+	const size_t n = 1 << 24;
+	std::mt19937 rng(5);
+	for (size_t k : {(size_t)2, (size_t)4, (size_t)16, (size_t)64, (size_t)256, (size_t)1024})
+	{
+		vector<vector<unsigned>> runs(k);
+		for (size_t i = 0; i < n; ++i)
+			runs[rng() % k].push_back(rng());
+		for (auto &r : runs)
+			std::sort(r.begin(), r.end());
+		vector<unsigned> out(n), tmp(n);
+		cout << n << " uint32 in " << k << " runs" << endl;
+		auto report = [&](const char *name, std::function<void()> f) {
+			double ms = time_ms(f);
+			cout << "  " << name << ": " << ms << " ms" << endl;
+		};
+		report("jan::merge_k (iter)  ", [&]{ jan::merge_k(runs, out.begin()); });
+		report("jan::merge_k (vector)", [&]{
+			jan::vector<unsigned> res;
+			jan::merge_k(runs, res);
+			simd_sink = res[n / 2];
+		});
+		report("std::priority_queue  ", [&]{
+			typedef std::pair<unsigned, size_t> item;
+			std::priority_queue<item, vector<item>, std::greater<item>> heap;
+			vector<size_t> pos(k, 0);
+			for (size_t i = 0; i < k; ++i)
+				if (!runs[i].empty())
+					heap.emplace(runs[i][0], i);
+			for (auto o = out.begin(); !heap.empty(); ++o)
+			{
+				size_t i = heap.top().second;
+				*o = heap.top().first;
+				heap.pop();
+				if (++pos[i] < runs[i].size())
+					heap.emplace(runs[i][pos[i]], i);
+			}
+		});
+		if (k <= 64)
+			report("chained jan::merge   ", [&]{
+				size_t len = 0;
+				for (auto &r : runs)
+				{
+					jan::merge(out.begin(), out.begin() + len, r.begin(), r.end(), tmp.begin());
+					len += r.size();
+					out.swap(tmp);
+				}
+			});
+	}
+}
+
+//定长键的比较吞吐: 每个键W个整数, 相邻两个键的公共前缀长度随机, 逐对做字典序比较;
+//以及两个只在最后一个元素不同的大数组上的mismatch
+template <typename T>
+void compare_keys_time(size_t width)
+{
+	const size_t keys = (1 << 24) / width;
+	jan::vector<T> buf;
+	buf.resize(keys * width, T(0));
+	std::mt19937_64 rng(9);
+	for (size_t k = 1; k < keys; ++k)
+	{
+		//与前一个键共享随机长度的前缀, 之后的元素重新生成
+		T *key = buf.begin() + k * width, *prev = key - width;
+		size_t common = rng() % (width + 1);
+		for (size_t i = 0; i < width; ++i)
+			key[i] = i < common ? prev[i] : static_cast<T>(rng() % 4);
+	}
+	const T *b = buf.begin();
+	auto report = [&](const char *name, std::function<size_t()> f) {
+		size_t less = 0;
+		double ms = time_ms([&]{ less = f(); });
+		cout << "  " << name << ": " << (keys - 1) / ms / 1e3 << " M cmp/s  " << 2.0 * buf.size() * sizeof(T) / ms / 1e6
+			 << " GB/s  less " << less << endl;
+	};
+	cout << keys << " keys of " << width << " x " << sizeof(T) * 8 << "-bit" << endl;
+	report("jan::lexicographical_compare", [&]{
+		size_t less = 0;
+		for (size_t k = 1; k < keys; ++k)
+			less += jan::lexicographical_compare(b + (k - 1) * width, b + k * width, b + k * width, b + (k + 1) * width);
+		return less;
+	});
+	report("element by element          ", [&]{
+		size_t less = 0;
+		for (size_t k = 1; k < keys; ++k)
+			less += jan::__lexicographical_compare(b + (k - 1) * width, b + k * width, b + k * width, b + (k + 1) * width,
+												   jan::_false_type());
+		return less;
+	});
+	report("std::lexicographical_compare", [&]{
+		size_t less = 0;
+		for (size_t k = 1; k < keys; ++k)
+			less += std::lexicographical_compare(b + (k - 1) * width, b + k * width, b + k * width, b + (k + 1) * width);
+		return less;
+	});
+}
+
+void test_compare_time()
+{
+	for (size_t w : {(size_t)4, (size_t)16, (size_t)64})
+	{
+		compare_keys_time<unsigned>(w);
+		compare_keys_time<unsigned long long>(w);
+	}
+	const size_t n = 1 << 24;
+	vector<unsigned> a(n, 1), c(n, 1);
+	c[n - 1] = 2;
+	const unsigned *pa = a.data(), *pc = c.data();
+	auto report = [&](const char *name, std::function<size_t()> f) {
+		size_t pos = 0;
+		double ms = time_ms([&]{ pos = f(); });
+		cout << "  " << name << ": " << 2.0 * n * sizeof(unsigned) / ms / 1e6 << " GB/s  at " << pos << endl;
+	};
+	cout << n << " uint32 mismatch" << endl;
+	report("jan::mismatch     ", [&]{ return (size_t)(jan::mismatch(pa, pa + n, pc).first - pa); });
+	report("element by element", [&]{ return (size_t)(jan::__mismatch(pa, pa + n, pc, jan::_false_type()).first - pa); });
+	report("std::mismatch     ", [&]{ return (size_t)(std::mismatch(pa, pa + n, pc).first - pa); });
+}
+
+//扩容时的搬迁: 元素是不能放进SSO缓冲区的std::string, 移动只交换指针, 拷贝要重新分配
+void test_relocate_time()
+{
+	const size_t n = 1 << 20;
+	const std::string val(64, 'x');
+	cout << n << " std::string(64) emplace_back" << endl;
+	cout << "  jan::vector: " << time_ms([&]{
+		jan::vector<std::string> v;
+		for (size_t i = 0; i < n; ++i)
+			v.emplace_back(val);
+	}) << " ms" << endl;
+	cout << "  std::vector: " << time_ms([&]{
+		vector<std::string> v;
+		for (size_t i = 0; i < n; ++i)
+			v.emplace_back(val);
+	}) << " ms" << endl;
+}
+
+//由n个计数求偏移表: 逐个累加, 寄存器内的向量扫描, 以及1..hardware_concurrency个线程的并行扫描
+void test_scan_time()
+{
+	const size_t n = 100000000;
+	vector<unsigned> cnt(n), off(n);
+	std::mt19937 rng(7);
+	for (auto &x : cnt)
+		x = rng() % 16;
+	const unsigned *c0 = cnt.data(), *c1 = c0 + n;
+	unsigned *o = off.data();
+	auto report = [&](const char *name, std::function<void()> f) {
+		double ms = time_ms(f);
+		cout << "  " << name << ": " << ms << " ms  " << 2.0 * n * sizeof(unsigned) / ms / 1e6 << " GB/s  last " << off[n - 1] << endl;
+	};
+	cout << n << " uint32 counts" << endl;
+	report("scalar inclusive", [&]{ jan::__inclusive_scan(c0, c1, o, jan::plus<unsigned>(), 0u, jan::_false_type()); });
+	report("simd inclusive  ", [&]{ jan::partial_sum(c0, c1, o); });
+	report("simd exclusive  ", [&]{ jan::exclusive_scan(c0, c1, o, 0u); });
+	report("std::partial_sum", [&]{ std::partial_sum(c0, c1, o); });
+	report("adjacent_diff   ", [&]{ jan::adjacent_difference(c0, c1, o); });
+	size_t max_threads = jan::_thread_pool::instance().size();
+	for (size_t t = 1; ; t = t * 2 < max_threads ? t * 2 : max_threads)
+	{
+		auto policy = jan::execution::par.with_threads(t);
+		cout << " " << t << " threads" << endl;
+		report("par inclusive   ", [&]{ jan::inclusive_scan(policy, c0, c1, o); });
+		report("par exclusive   ", [&]{ jan::exclusive_scan(policy, c0, c1, o, 0u); });
+		report("par adjacent    ", [&]{ jan::adjacent_difference(policy, c0, c1, o); });
+		if (t == max_threads)
+			break;
+	}
+}
+
+//构造bytes字节的vector<double>(n, 1.0): 顺序构造所有页都由调用者首次写入,
+//par构造时各线程写入自己之后要处理的那一块; 构造后再用par求和, 看页面分布对读取的影响
+void test_construct_time(size_t bytes = size_t(4) << 30)
+{
+	const size_t n = bytes / sizeof(double);
+	const size_t threads = jan::_thread_pool::instance().size();
+	cout << bytes / (1 << 20) << " MB vector<double>, " << threads << " threads" << endl;
+	auto run = [&](const char *name, std::function<jan::vector<double> *()> make) {
+		jan::vector<double> *v = nullptr;
+		double build = time_ms([&]{ v = make(); });
+		double sum = 0;
+		double read = time_ms([&]{ sum = jan::accumulate(jan::execution::par, v->begin(), v->end(), 0.0); });
+		cout << "  " << name << ": construct " << build << " ms  " << bytes / build / 1e6 << " GB/s, par sum "
+			 << read << " ms  " << sum << endl;
+		delete v;
+	};
+	run("jan::vector(n, val)     ", [&]{ return new jan::vector<double>(n, 1.0); });
+	run("jan::vector(par, n, val)", [&]{ return new jan::vector<double>(jan::execution::par, n, 1.0); });
+	cout << "  std::vector(n, val)     : " << time_ms([&]{ vector<double> v(n, 1.0); simd_sink = v[n / 2]; }) << " ms" << endl;
+}
+
+//n个double上各并行算法在1..hardware_concurrency个线程时的耗时
+void test_parallel_time()
+{
+	const size_t n = 1 << 26;
+	vector<double> a(n), b(n), c(n);
+	for (size_t i = 0; i < n; ++i)
+		a[i] = b[i] = (double)(i % 1000) / 7;
+	size_t max_threads = jan::_thread_pool::instance().size();
+	double seq_sum = 0;
+	cout << "seq accumulate: " << time_ms([&]{ seq_sum = jan::accumulate(a.begin(), a.end(), 0.0); }) << " ms  " << seq_sum << endl;
+	vector<size_t> thread_counts;
+	for (size_t t = 1; t < max_threads; t *= 2)
+		thread_counts.push_back(t);
+	thread_counts.push_back(max_threads);
+	for (size_t t : thread_counts)
+	{
+		auto policy = jan::execution::par.with_threads(t);
+		double sum = 0, dot = 0;
+		long cnt = 0;
+		bool miss = false;
+		cout << t << " threads: "
+			 << "accumulate " << time_ms([&]{ sum = jan::accumulate(policy, a.begin(), a.end(), 0.0); }) << " ms  "
+			 << "inner_product " << time_ms([&]{ dot = jan::inner_product(policy, a.begin(), a.end(), b.begin(), 0.0); }) << " ms  "
+			 << "count_if " << time_ms([&]{ cnt = jan::count_if(policy, a.begin(), a.end(), [](double x){ return x > 50; }); }) << " ms  "
+			 << "find(miss) " << time_ms([&]{ miss = jan::find(policy, a.begin(), a.end(), -1.0) == a.end(); }) << " ms  "
+			 << "copy " << time_ms([&]{ jan::copy(policy, a.begin(), a.end(), c.begin()); }) << " ms  "
+			 << "fill " << time_ms([&]{ jan::fill(policy, c.begin(), c.end(), 1.0); }) << " ms  "
+			 << "(" << sum << ", " << dot << ", " << cnt << ", " << miss << ")" << endl;
+	}
+}
+
+//threads个生产者和threads个消费者共传递n个元素, 返回吞吐量(百万元素/秒)
+template<typename Push, typename Pop>
+double queue_throughput(int threads, long n, Push push, Pop pop)
+{
+	atomic<long> popped(0);
+	vector<thread> pool;
+	double ms = time_ms([&]{
+		for (int p = 0; p < threads; ++p)
+			pool.emplace_back([&, p]{
+				for (long i = p; i < n; i += threads)
+					while (!push(i))
+						this_thread::yield();
+			});
+		for (int c = 0; c < threads; ++c)
+			pool.emplace_back([&]{
+				long val;
+				while (popped.load(memory_order_relaxed) < n)
+				{
+					long k = pop(val);
+					if (k == 0)
+						this_thread::yield();
+					else
+						popped += k;
+				}
+			});
+		for (auto & t : pool)
+			t.join();
+	});
+	return n / ms / 1000;
+}
+
+void test_spsc_queue_time()
+{
+	const long n = 10000000;
+	jan::spsc_queue<long> q(1024);
+	cout << "spsc try_push/try_pop: "
+		 << queue_throughput(1, n, [&](long v){ return q.try_push(v); },
+							 [&](long & v){ return q.try_pop(v) ? 1L : 0L; })
+		 << " M/s" << endl;
+
+	//批量传递, 每次最多64个
+	double ms = time_ms([&]{
+		thread producer([&]{
+			long buf[64];
+			for (long i = 0; i < n; i += 64)
+			{
+				long k = min(64L, n - i), done = 0;
+				for (long j = 0; j < k; ++j)
+					buf[j] = i + j;
+				while (done < k)
+				{
+					long pushed = q.try_push_n(buf + done, k - done);
+					if (pushed == 0)
+						this_thread::yield();
+					done += pushed;
+				}
+			}
+		});
+		long buf[64];
+		for (long got = 0; got < n; )
+		{
+			long k = q.try_pop_n(buf, 64);
+			if (k == 0)
+				this_thread::yield();
+			got += k;
+		}
+		producer.join();
+	});
+	cout << "spsc try_push_n/try_pop_n(64): " << n / ms / 1000 << " M/s" << endl;
+
+	mutex m;
+	deque<long> dq;
+	cout << "mutex + std::deque: "
+		 << queue_throughput(1, n, [&](long v){ lock_guard<mutex> lk(m); dq.push_back(v); return true; },
+							 [&](long & v){
+								 lock_guard<mutex> lk(m);
+								 if (dq.empty()) return 0L;
+								 v = dq.front(); dq.pop_front(); return 1L;
+							 })
+		 << " M/s" << endl;
+
+	//两个队列之间来回传递一个元素, 测往返延迟
+	const long rounds = 1000000;
+	jan::spsc_queue<long> ping(16), pong(16);
+	ms = time_ms([&]{
+		thread echo([&]{
+			long v;
+			for (long i = 0; i < rounds; ++i)
+			{
+				while (!ping.try_pop(v))
+					this_thread::yield();
+				while (!pong.try_push(v))
+					this_thread::yield();
+			}
+		});
+		long v;
+		for (long i = 0; i < rounds; ++i)
+		{
+			ping.try_push(i);
+			while (!pong.try_pop(v))
+				this_thread::yield();
+		}
+		echo.join();
+	});
+	cout << "spsc round trip latency: " << ms * 1e6 / rounds << " ns" << endl;
+}
+
+//与jan::mpmc_queue接口相同的加锁队列, 作为延迟测试的对照
+struct locked_deque
+{
+	mutex m;
+	deque<long> dq;
+	bool try_push(long v) { lock_guard<mutex> lk(m); dq.push_back(v); return true; }
+	bool try_pop(long & v)
+	{
+		lock_guard<mutex> lk(m);
+		if (dq.empty())
+			return false;
+		v = dq.front();
+		dq.pop_front();
+		return true;
+	}
+};
+
+//threads个客户端各自往req推入发送时刻, 等待rep中的一个回复, threads个服务端把req中取出的元素原样放进rep,
+//每个客户端同时只有一个请求在队列中, 所以测到的是往返延迟而不是排队时间, 返回(中位数, p99), 单位ns
+template<typename Queue>
+pair<double, double> queue_round_trip(int threads, long rounds, Queue & req, Queue & rep)
+{
+	auto now_ns = []{ return (long)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count(); };
+	const long total = rounds / threads * threads;
+	atomic<long> served(0);
+	vector<vector<long>> samples(threads);
+	vector<thread> pool;
+	for (int s = 0; s < threads; ++s)
+		pool.emplace_back([&]{
+			long v;
+			while (served.load(memory_order_relaxed) < total)
+			{
+				if (!req.try_pop(v))
+				{
+					this_thread::yield();
+					continue;
+				}
+				while (!rep.try_push(v))
+					this_thread::yield();
+				++served;
+			}
+		});
+	for (int c = 0; c < threads; ++c)
+		pool.emplace_back([&, c]{
+			long v;
+			samples[c].reserve(total / threads);
+			for (long i = 0; i < total / threads; ++i)
+			{
+				while (!req.try_push(now_ns()))
+					this_thread::yield();
+				while (!rep.try_pop(v))
+					this_thread::yield();
+				samples[c].push_back(now_ns() - v);
+			}
+		});
+	for (auto & t : pool)
+		t.join();
+	vector<long> all;
+	for (auto & s : samples)
+		all.insert(all.end(), s.begin(), s.end());
+	std::sort(all.begin(), all.end());
+	return make_pair((double)all[all.size() / 2], (double)all[all.size() * 99 / 100]);
+}
+
+void test_mpmc_queue_time()
+{
+	const long n = 4000000;
+	for (int threads : {1, 2, 4, 8, 16})
+	{
+		jan::mpmc_queue<long> q(4096);
+		double single = queue_throughput(threads, n,
+										 [&](long v){ return q.try_push(v); },
+										 [&](long & v){ return q.try_pop(v) ? 1L : 0L; });
+		jan::mpmc_queue<long> qb(4096);
+		double batch = queue_throughput(threads, n,
+										[&](long v){ return qb.try_push(v); },
+										[&](long &){ long buf[32]; return (long)qb.try_pop_n(buf, 32); });
+		mutex m;
+		deque<long> dq;
+		double locked = queue_throughput(threads, n,
+										 [&](long v){ lock_guard<mutex> lk(m); dq.push_back(v); return true; },
+										 [&](long & v){
+											 lock_guard<mutex> lk(m);
+											 if (dq.empty()) return 0L;
+											 v = dq.front(); dq.pop_front(); return 1L;
+										 });
+		cout << threads << "P/" << threads << "C  mpmc: " << single
+			 << " M/s  mpmc pop_n(32): " << batch
+			 << " M/s  mutex+deque: " << locked << " M/s" << endl;
+	}
+
+	const long rounds = 200000;
+	for (int threads : {1, 2, 4, 8, 16})
+	{
+		jan::mpmc_queue<long> req(4096), rep(4096);
+		auto lock_free = queue_round_trip(threads, rounds, req, rep);
+		locked_deque lreq, lrep;
+		auto locked = queue_round_trip(threads, rounds, lreq, lrep);
+		cout << threads << "P/" << threads << "C  round trip latency p50/p99  mpmc: "
+			 << lock_free.first << "/" << lock_free.second << " ns  mutex+deque: "
+			 << locked.first << "/" << locked.second << " ns" << endl;
+	}
+}
+//并发优先队列的一次操作记录, 用于离线计算rank error
+struct pq_op
+{
+	size_t ticket;
+	unsigned long long key;
+	bool push;
+};
+
+//threads个线程各自重复: 取出最早的定时器, 加上随机间隔后放回, 共pairs次, 返回吞吐量(百万次操作/秒)
+//log不为空时每次操作都从一个全局计数器领取序号并记录下来:
+//push在操作之前领取, pop在操作之后领取, 保证同一个元素的push排在pop之前
+template<typename Push, typename Pop>
+double pq_throughput(int threads, long pairs, Push push, Pop pop, vector<vector<pq_op>> *log)
+{
+	atomic<size_t> ticket(0);
+	const long prefill = 100000;
+	if (log)
+		log->assign(threads + 1, vector<pq_op>());
+	for (long i = 0; i < prefill; ++i)
+	{
+		unsigned long long key = rand() % 1000000;
+		if (log)
+			(*log)[threads].push_back(pq_op{ticket++, key, true});
+		push(key);
+	}
+	vector<thread> workers;
+	double ms = time_ms([&]{
+		for (int t = 0; t < threads; ++t)
+			workers.emplace_back([&, t]{
+				unsigned long long seed = t * 0x9E3779B97F4A7C15ULL + 1;
+				for (long i = 0; i < pairs / threads; ++i)
+				{
+					unsigned long long key;
+					if (!pop(key))
+						continue;
+					if (log)
+						(*log)[t].push_back(pq_op{ticket++, key, false});
+					seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+					key += seed % 1000000;
+					if (log)
+						(*log)[t].push_back(pq_op{ticket++, key, true});
+					push(key);
+				}
+			});
+		for (auto &w : workers)
+			w.join();
+	});
+	return 2.0 * pairs / ms / 1000;
+}
+
+//按序号重放所有操作, pop的rank error是当时队列中比它更早到期的元素个数, 返回平均值和最大值
+pair<double, size_t> pq_rank_error(const vector<vector<pq_op>> &log)
+{
+	vector<pq_op> ops;
+	for (auto &v : log)
+		ops.insert(ops.end(), v.begin(), v.end());
+	sort(ops.begin(), ops.end(), [](const pq_op &a, const pq_op &b){ return a.ticket < b.ticket; });
+	vector<unsigned long long> keys;
+	for (auto &op : ops)
+		keys.push_back(op.key);
+	sort(keys.begin(), keys.end());
+	keys.erase(unique(keys.begin(), keys.end()), keys.end());
+	//树状数组, fenwick[i]统计压缩后的key的出现次数
+	vector<long> fenwick(keys.size() + 1, 0);
+	double total = 0;
+	size_t worst = 0, pops = 0;
+	for (auto &op : ops)
+	{
+		size_t idx = lower_bound(keys.begin(), keys.end(), op.key) - keys.begin();
+		if (!op.push)
+		{
+			long smaller = 0;
+			for (size_t i = idx; i > 0; i -= i & -i)
+				smaller += fenwick[i];
+			total += smaller;
+			worst = max(worst, (size_t)smaller);
+			++pops;
+		}
+		for (size_t i = idx + 1; i < fenwick.size(); i += i & -i)
+			fenwick[i] += op.push ? 1 : -1;
+	}
+	return make_pair(pops ? total / pops : 0.0, worst);
+}
+
+void test_multi_queue_time()
+{
+	typedef unsigned long long key_t;
+	typedef jan::greater<key_t> earliest;
+	const long pairs = 2000000, logged_pairs = 200000;
+	srand((unsigned)time(0));
+	for (int threads : {1, 2, 4, 8, 16, 32, 64})
+	{
+		mutex m;
+		jan::priority_queue<key_t, jan::vector<key_t, jan::malloc_alloc>, earliest> locked_pq;
+		auto locked_push = [&](key_t k){ lock_guard<mutex> lk(m); locked_pq.push(k); };
+		auto locked_pop = [&](key_t &k){
+			lock_guard<mutex> lk(m);
+			if (locked_pq.empty()) return false;
+			k = locked_pq.top(); locked_pq.pop(); return true;
+		};
+		double locked = pq_throughput(threads, pairs, locked_push, locked_pop, nullptr);
+
+		cout << threads << " threads  mutex+heap: " << locked << " M/s";
+		for (size_t choices : {2, 4})
+		{
+			jan::multi_queue<key_t, earliest> mq(2 * threads, choices);
+			double relaxed = pq_throughput(threads, pairs,
+										   [&](key_t k){ mq.push(k); },
+										   [&](key_t &k){ return mq.try_pop(k); }, nullptr);
+			jan::multi_queue<key_t, earliest> mq_log(2 * threads, choices);
+			vector<vector<pq_op>> log;
+			pq_throughput(threads, logged_pairs,
+						  [&](key_t k){ mq_log.push(k); },
+						  [&](key_t &k){ return mq_log.try_pop(k); }, &log);
+			auto err = pq_rank_error(log);
+			cout << "  multi_queue(" << 2 * threads << "," << choices << "): " << relaxed
+				 << " M/s rank error avg " << err.first << " max " << err.second;
+		}
+		cout << endl;
+	}
+}
+
+struct lru_entry
+{
+  int key;
+  jan::list_hook hook;
+  explicit lru_entry(int k) : key(k) { }
+};
+
+void test_intrusive_list()
+{
+  lru_entry entries[5] = {lru_entry(0), lru_entry(1), lru_entry(2), lru_entry(3), lru_entry(4)};
+  jan::intrusive_list<lru_entry, &lru_entry::hook> lru;
+  for (auto & e : entries)
+    lru.push_front(e);
+  //访问2和0, 把它们移到最前面
+  lru.splice(lru.begin(), lru, lru.iterator_to(entries[2]));
+  lru.splice(lru.begin(), lru, lru.iterator_to(entries[0]));
+  //淘汰最久没有访问的
+  lru.pop_back();
+  cout << "lru : ";
+  for (auto & e : lru)
+    cout << e.key << " ";
+  cout << "size = " << lru.size() << " evicted linked = " << entries[1].hook.is_linked() << endl;
+}
+void test_priority_queue()
+{
+  jan::priority_queue<int> pq;
+  pq.push(3);
+  pq.emplace(7);
+  pq.push(1);
+  int batch[] = {9, 4, 6, 2, 8};
+  pq.push_range(batch, batch + 5);
+  vector<int> top3;
+  pq.pop_n(back_inserter(top3), 3);
+  for (int v : top3)
+    cout << v << " ";
+  cout << "| ";
+  while (!pq.empty())
+  {
+    cout << pq.top() << " ";
+    pq.pop();
+  }
+  cout << endl;
+}
 int main()
 {
   std::vector<int> vec;
@@ -405,7 +1623,33 @@ int main()
 	// test_my_copy();
   // test_uninitia();
   // test_vector();
+  // test_type_traits();
   test_my_list();
+  // test_intrusive_list();
+  // test_priority_queue();
+  // test_my_list_time();
+  // test_list_sort_time();
+  // test_list_merge_size();
+  // test_heap_time();
+  // test_dijkstra_time();
+  // test_sort_time();
+  // test_stable_sort_time();
+  // test_radix_sort_time();
+  // test_simd_time();
+  // test_stream_time();
+  // test_set_time();
+  // test_select_time();
+  // test_merge_k_time();
+  // test_compare_time();
+  // test_relocate_time();
+  // test_search_time();
+  // test_scan_time();
+  // test_parallel_time();
+  // test_construct_time();
+  // test_unrolled_list_time();
+  // test_spsc_queue_time();
+  // test_mpmc_queue_time();
+  // test_multi_queue_time();
 	cin.get();
 	return 0;
 }
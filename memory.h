@@ -4,7 +4,12 @@
 #include "my_type_traits.h"
 #include "my_algorithm.h"
 #include "my_allocator.h"
-//u_copy, u_fill, u_fill_n
+#include "my_execution.h"
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+//u_copy, u_move, u_fill, u_fill_n, u_default_construct_n, u_value_construct_n
 namespace jan{
   /**
    * @brief 如果待填充元素的类型为 POD, 就直接调用fill_n(use operpatr=)
@@ -24,7 +29,7 @@ namespace jan{
   }
   
   /**
-   * @brief 如果待填充的元素不是 POD 类型，就用构造函数
+   * @brief 如果待填充的元素不是 POD 类型，就用构造函数, 某个构造抛出异常时析构已经构造的元素再重新抛出
    * 
    * @tparam ForwardIter 
    * @tparam Size 
@@ -37,12 +42,15 @@ namespace jan{
   template <typename ForwardIter, typename Size, typename T>
   inline ForwardIter __uninitialized_fill_n_aux(ForwardIter first, Size n, const T & val, _false_type)
   {
-    while (n--)
-    {
-      construct(&*first,val);
-      ++first;
+    ForwardIter cur = first;
+    try {
+      for (; n > 0; --n, ++cur)
+        jan::construct(&*cur, val);
+    } catch (...) {
+      jan::destroy(first, cur);
+      throw;
     }
-    return first;
+    return cur;
   }
 
   /**
@@ -61,7 +69,7 @@ namespace jan{
   inline ForwardIter __uninitialized_fill_n(ForwardIter first, Size n, const T & val, T1 *)
   {
     using is_POD = typename type_traits<T1>::is_POD_type;
-    return __uninitialized_fill_n_aux(first,n,val,is_POD());
+    return jan::__uninitialized_fill_n_aux(first,n,val,is_POD());
   }
 
   /**
@@ -78,36 +86,260 @@ namespace jan{
   template <typename ForwardIter, typename Size, typename T>
   inline ForwardIter uninitialized_fill_n(ForwardIter first, Size n, const T & val)
   {
-    return __uninitialized_fill_n(first, n, val, value_type(first));
+    return jan::__uninitialized_fill_n(first, n, val, value_type(first));
   }
 
   /************uninitialized_copy***********/
-  template <typename ForwardIter, typename OutputIter>
-  inline OutputIter __uninitialized_copy_aux(ForwardIter first, ForwardIter last,
-                                            OutputIter res, _false_type)
+  /**
+   * @brief 逐个拷贝构造, 某个构造抛出异常时析构已经构造的元素再重新抛出, 返回构造完的下一个位置
+   * 
+   * @tparam InputIter 
+   * @tparam ForwardIter 
+   * @param first 
+   * @param last 
+   * @param res 
+   * @return ForwardIter 
+   */
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter __uninitialized_copy_aux(InputIter first, InputIter last,
+                                              ForwardIter res, _false_type)
+  {
+    ForwardIter cur = res;
+    try {
+      for(;first != last; ++first, ++cur)
+        jan::construct(&*cur,*first);
+    } catch (...) {
+      jan::destroy(res, cur);
+      throw;
+    }
+    return cur;
+  }
+
+  //POD类型由copy按字节拷贝, 指针区间就是一次memmove
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter __uninitialized_copy_aux(InputIter first, InputIter last,
+                                              ForwardIter res, _true_type)
+  {
+    return jan::copy(first, last, res);
+  }
+
+  template <typename InputIter, typename ForwardIter, typename T>
+  inline ForwardIter __uninitialized_copy(InputIter first, InputIter last, ForwardIter res, T *)
+  {
+    using is_POD = typename type_traits<T>::is_POD_type;
+    return jan::__uninitialized_copy_aux(first,last,res,is_POD());
+  }
+
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter uninitialized_copy(InputIter first, InputIter last, ForwardIter res)
+  {
+    return jan::__uninitialized_copy(first, last, res, value_type(first));
+  }
+
+  /************uninitialized_move***********/
+  /**
+   * @brief 逐个移动构造, 异常时析构已经构造的元素, 但已经被移走的源元素无法恢复
+   *        需要强异常保证时使用uninitialized_move_if_noexcept
+   * 
+   * @tparam InputIter 
+   * @tparam ForwardIter 
+   * @param first 
+   * @param last 
+   * @param res 
+   * @return ForwardIter 
+   */
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter __uninitialized_move_aux(InputIter first, InputIter last,
+                                              ForwardIter res, _false_type)
   {
-    for(;first != last; ++first, ++res)
-      construct(&*res,*first);
+    ForwardIter cur = res;
+    try {
+      for(;first != last; ++first, ++cur)
+        jan::construct(&*cur,std::move(*first));
+    } catch (...) {
+      jan::destroy(res, cur);
+      throw;
+    }
+    return cur;
   }
 
-  template <typename ForwardIter, typename OutputIter>
-  inline OutputIter __uninitialized_copy_aux(ForwardIter first, ForwardIter last,
-                                             OutputIter res, _true_type)
+  //POD类型的移动就是拷贝
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter __uninitialized_move_aux(InputIter first, InputIter last,
+                                              ForwardIter res, _true_type)
   {
-    return copy(first, last, res);
+    return jan::copy(first, last, res);
   }
 
-  template <typename ForwardIter, typename OutputIter, typename T>
-  inline OutputIter __uninitialized_copy(ForwardIter first, ForwardIter last, OutputIter res, T *)
+  template <typename InputIter, typename ForwardIter, typename T>
+  inline ForwardIter __uninitialized_move(InputIter first, InputIter last, ForwardIter res, T *)
   {
     using is_POD = typename type_traits<T>::is_POD_type;
-    return __uninitialized_copy_aux(first,last,res,is_POD());
+    return jan::__uninitialized_move_aux(first,last,res,is_POD());
+  }
+
+  /**
+   * @brief 把[first,last)的元素移动构造到res开始的未初始化空间, 返回构造完的下一个位置
+   * 
+   * @tparam InputIter 
+   * @tparam ForwardIter 
+   * @param first 
+   * @param last 
+   * @param res 
+   * @return ForwardIter 
+   */
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter uninitialized_move(InputIter first, InputIter last, ForwardIter res)
+  {
+    return jan::__uninitialized_move(first, last, res, value_type(first));
+  }
+
+  /**
+   * @brief 移动构造不会抛出异常, 或者根本不能拷贝时才移动, 否则拷贝
+   *        这样中途失败时源区间的元素都还完好, 容器扩容可以保持强异常保证
+   * 
+   * @tparam T 
+   */
+  template <typename T>
+  struct __move_if_noexcept_tag
+  {
+    typedef typename __bool_type<std::is_nothrow_move_constructible<T>::value
+                                 || !std::is_copy_constructible<T>::value>::type type;
+  };
+
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter __uninitialized_move_if_noexcept(InputIter first, InputIter last,
+                                                      ForwardIter res, _true_type)
+  {
+    return jan::uninitialized_move(first, last, res);
+  }
+
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter __uninitialized_move_if_noexcept(InputIter first, InputIter last,
+                                                      ForwardIter res, _false_type)
+  {
+    return jan::uninitialized_copy(first, last, res);
+  }
+
+  template <typename InputIter, typename ForwardIter, typename T>
+  inline ForwardIter __uninitialized_move_if_noexcept(InputIter first, InputIter last, ForwardIter res, T *)
+  {
+    return jan::__uninitialized_move_if_noexcept(first, last, res, typename __move_if_noexcept_tag<T>::type());
+  }
+
+  /**
+   * @brief 容器搬迁元素时使用: 能安全移动就移动, 否则拷贝; POD类型都是一次memmove
+   * 
+   * @tparam InputIter 
+   * @tparam ForwardIter 
+   * @param first 
+   * @param last 
+   * @param res 
+   * @return ForwardIter 
+   */
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter uninitialized_move_if_noexcept(InputIter first, InputIter last, ForwardIter res)
+  {
+    return jan::__uninitialized_move_if_noexcept(first, last, res, value_type(first));
+  }
+
+  /************uninitialized_default_construct_n***********/
+  //默认构造平凡时什么也不用做, 只需要把迭代器前移n步
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter __uninitialized_default_construct_n_aux(ForwardIter first, Size n, T *, _true_type)
+  {
+    jan::advance(first, n);
+    return first;
+  }
+
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter __uninitialized_default_construct_n_aux(ForwardIter first, Size n, T *, _false_type)
+  {
+    ForwardIter cur = first;
+    try {
+      for (; n > 0; --n, ++cur)
+        ::new (static_cast<void *>(&*cur)) T;
+    } catch (...) {
+      jan::destroy(first, cur);
+      throw;
+    }
+    return cur;
+  }
+
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter __uninitialized_default_construct_n(ForwardIter first, Size n, T * p)
+  {
+    using trivial = typename type_traits<T>::has_trivial_default_constructor;
+    return jan::__uninitialized_default_construct_n_aux(first, n, p, trivial());
+  }
+
+  /**
+   * @brief 默认初始化n个元素(T t;), 平凡类型的值不确定, 返回构造完的下一个位置
+   * 
+   * @tparam ForwardIter 
+   * @tparam Size 
+   * @param first 
+   * @param n 
+   * @return ForwardIter 
+   */
+  template <typename ForwardIter, typename Size>
+  inline ForwardIter uninitialized_default_construct_n(ForwardIter first, Size n)
+  {
+    return jan::__uninitialized_default_construct_n(first, n, value_type(first));
+  }
+
+  /************uninitialized_value_construct_n***********/
+  //平凡类型的值初始化就是清零, 指针区间直接memset, 其余交给fill_n
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter __uninitialized_value_construct_n_aux(ForwardIter first, Size n, T *, _true_type)
+  {
+    return jan::fill_n(first, n, T());
+  }
+
+  template <typename T, typename Size>
+  inline T* __uninitialized_value_construct_n_aux(T* first, Size n, T *, _true_type)
+  {
+    if (n <= 0)
+      return first;
+    memset(static_cast<void *>(first), 0, static_cast<size_t>(n) * sizeof(T));
+    return first + n;
+  }
+
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter __uninitialized_value_construct_n_aux(ForwardIter first, Size n, T *, _false_type)
+  {
+    ForwardIter cur = first;
+    try {
+      for (; n > 0; --n, ++cur)
+        ::new (static_cast<void *>(&*cur)) T();
+    } catch (...) {
+      jan::destroy(first, cur);
+      throw;
+    }
+    return cur;
+  }
+
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter __uninitialized_value_construct_n(ForwardIter first, Size n, T * p)
+  {
+    using trivial = typename __tag_and<typename type_traits<T>::has_trivial_default_constructor,
+                                       typename type_traits<T>::is_POD_type>::type;
+    return jan::__uninitialized_value_construct_n_aux(first, n, p, trivial());
   }
 
-  template <typename ForwardIter, typename OutputIter>
-  inline OutputIter uninitialized_copy(ForwardIter first, ForwardIter last, OutputIter res)
+  /**
+   * @brief 值初始化n个元素(T t{};), 返回构造完的下一个位置
+   * 
+   * @tparam ForwardIter 
+   * @tparam Size 
+   * @param first 
+   * @param n 
+   * @return ForwardIter 
+   */
+  template <typename ForwardIter, typename Size>
+  inline ForwardIter uninitialized_value_construct_n(ForwardIter first, Size n)
   {
-    return __uninitialized_copy(first, last, res, value_type(first));
+    return jan::__uninitialized_value_construct_n(first, n, value_type(first));
   }
 
   
@@ -115,29 +347,158 @@ namespace jan{
   template <typename ForwardIter, typename T>
   inline ForwardIter __uninitialized_fill_aux(ForwardIter first, ForwardIter last, const T & val, _true_type)
   {
-    return fill(first,last,val);
+    return jan::fill(first,last,val);
   }
   template <typename ForwardIter, typename T>
   inline ForwardIter __uninitialized_fill_aux(ForwardIter first, ForwardIter last, const T & val, _false_type)
   {
-    for(; first != last; ++first)
-      construct(&*first,val);
-    return first;
+    ForwardIter cur = first;
+    try {
+      for(; cur != last; ++cur)
+        jan::construct(&*cur,val);
+    } catch (...) {
+      jan::destroy(first, cur);
+      throw;
+    }
+    return cur;
   }
   template <typename ForwardIter, typename T, typename T1>
   inline ForwardIter __uninitialized_fill(ForwardIter first, ForwardIter last, const T & val, T1 *)
   {
     using is_POD = typename type_traits<T1>::is_POD_type;
-    return __uninitialized_fill_aux(first,last,val,is_POD());
+    return jan::__uninitialized_fill_aux(first,last,val,is_POD());
   }
 
   template <typename ForwordIter, typename T>
   inline ForwordIter uninitialized_fill(ForwordIter first, ForwordIter last, const T & val)
   {
-    return __uninitialized_fill(first,last,val,value_type(first));
+    return jan::__uninitialized_fill(first,last,val,value_type(first));
   }
 
 
+  /************带执行策略的uninitialized_fill_n / uninitialized_copy***********/
+  /**
+   * @brief 在线程池上并行构造[first, first + n): 与并行算法一样静态切块, 第c块总是由同一个线程构造,
+   *        之后用同样的策略并行处理这个区间时每一页都由访问它的线程首次写入(first-touch),
+   *        NUMA系统上页面分布在各线程所在的结点, 而不是全部落在调用者的结点上
+   *        某一块构造失败时这一块自己回滚, 其余构造完的块在所有线程结束后析构, 再重新抛出异常
+   * 
+   * @tparam RandomIter 
+   * @tparam Build 
+   * @param policy 
+   * @param first 
+   * @param n 
+   * @param build build(b, e)构造[first + b, first + e)
+   * @return RandomIter first + n
+   */
+  template <typename RandomIter, typename Build>
+  RandomIter __parallel_construct(const execution::parallel_policy &policy, RandomIter first, size_t n, Build build)
+  {
+    const size_t chunks = __parallel_chunks(policy, n);
+    std::vector<char> built(chunks, 0);
+    auto task = [&](size_t c) {
+      build(__chunk_begin(n, c, chunks), __chunk_begin(n, c + 1, chunks));
+      built[c] = 1;
+    };
+    try {
+      _thread_pool::instance().run(chunks, task);
+    } catch (...) {
+      for (size_t c = 0; c < chunks; ++c)
+        if (built[c])
+          jan::destroy(first + __chunk_begin(n, c, chunks), first + __chunk_begin(n, c + 1, chunks));
+      throw;
+    }
+    return first + n;
+  }
+
+  template <typename ForwardIter, typename Size, typename T>
+  inline ForwardIter uninitialized_fill_n(const execution::sequenced_policy &, ForwardIter first, Size n, const T & val)
+  {
+    return jan::uninitialized_fill_n(first, n, val);
+  }
+
+  template <typename RandomIter, typename Size, typename T>
+  RandomIter __uninitialized_fill_n_par_aux(const execution::parallel_policy &policy, RandomIter first, Size n,
+                                            const T & val, _true_type)
+  {
+    if (n <= 0)
+      return first;
+    return jan::__parallel_construct(policy, first, static_cast<size_t>(n), [&](size_t b, size_t e) {
+      jan::uninitialized_fill_n(first + b, e - b, val);
+    });
+  }
+
+  template <typename RandomIter, typename Size, typename T>
+  inline RandomIter __uninitialized_fill_n_par_aux(const execution::parallel_policy &, RandomIter first, Size n,
+                                                   const T & val, _false_type)
+  {
+    return jan::uninitialized_fill_n(first, n, val);
+  }
+
+  /**
+   * @brief 并行初始化n个值为val的元素, 每块仍然调用uninitialized_fill_n, 走memset/non-temporal写
+   *        只有POD类型才并行: 非POD的构造函数可能从默认的level_two_alloc_template或节点池分配内存,
+   *        它们都不是线程安全的, 所以非POD类型退回串行的uninitialized_fill_n
+   * 
+   * @tparam RandomIter 
+   * @tparam Size 
+   * @tparam T 
+   * @param policy 
+   * @param first 
+   * @param n 
+   * @param val 
+   * @return RandomIter 
+   */
+  template <typename RandomIter, typename Size, typename T>
+  inline RandomIter uninitialized_fill_n(const execution::parallel_policy &policy, RandomIter first, Size n, const T & val)
+  {
+    using is_POD = typename type_traits<typename iterator_traits<RandomIter>::value_type>::is_POD_type;
+    return jan::__uninitialized_fill_n_par_aux(policy, first, n, val, is_POD());
+  }
+
+  template <typename InputIter, typename ForwardIter>
+  inline ForwardIter uninitialized_copy(const execution::sequenced_policy &, InputIter first, InputIter last, ForwardIter res)
+  {
+    return jan::uninitialized_copy(first, last, res);
+  }
+
+  template <typename RandomIter, typename RandomOutIter>
+  RandomOutIter __uninitialized_copy_par_aux(const execution::parallel_policy &policy, RandomIter first, RandomIter last,
+                                             RandomOutIter res, _true_type)
+  {
+    return jan::__parallel_construct(policy, res, static_cast<size_t>(last - first), [&](size_t b, size_t e) {
+      jan::uninitialized_copy(first + b, first + e, res + b);
+    });
+  }
+
+  template <typename RandomIter, typename RandomOutIter>
+  inline RandomOutIter __uninitialized_copy_par_aux(const execution::parallel_policy &, RandomIter first, RandomIter last,
+                                                    RandomOutIter res, _false_type)
+  {
+    return jan::uninitialized_copy(first, last, res);
+  }
+
+  /**
+   * @brief 并行拷贝构造, 源区间与目标区间不能重叠, 每块仍然调用uninitialized_copy, 走memmove
+   *        与uninitialized_fill_n一样只有POD类型才并行, 非POD类型的拷贝构造可能用到非线程安全的分配器,
+   *        退回串行的uninitialized_copy
+   * 
+   * @tparam RandomIter 
+   * @tparam RandomOutIter 
+   * @param policy 
+   * @param first 
+   * @param last 
+   * @param res 
+   * @return RandomOutIter 
+   */
+  template <typename RandomIter, typename RandomOutIter>
+  inline RandomOutIter uninitialized_copy(const execution::parallel_policy &policy, RandomIter first, RandomIter last,
+                                          RandomOutIter res)
+  {
+    using is_POD = typename type_traits<typename iterator_traits<RandomOutIter>::value_type>::is_POD_type;
+    return jan::__uninitialized_copy_par_aux(policy, first, last, res, is_POD());
+  }
+
 }
 
 
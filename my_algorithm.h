@@ -2,18 +2,23 @@
 #define __MY_ALGORITHM_H_
 #include "my_iterator.h"
 #include "my_type_traits.h"
+#include "my_functional.h"
+#include "my_heap.h"
+#include "my_allocator.h"
+#include "my_simd.h"
 #include <algorithm>
 #include <vector>
 #include <cstddef>
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <type_traits>
 
 namespace jan
 {
 
 	template<typename InputIter, typename T>
-	T accumulate(InputIter first, InputIter last, T init)
+	T __accumulate(InputIter first, InputIter last, T init, _false_type)
 	{
 		for (; first != last; ++first)
 		{
@@ -22,44 +27,77 @@ namespace jan
 		return init;
 	}
 
+#ifdef __JAN_SIMD_X86
+	//指向int/float/double的指针, 用向量化的求和
+	template<typename Ptr, typename T>
+	inline T __accumulate(Ptr first, Ptr last, T init, _true_type)
+	{
+		return init + jan::__simd_sum<T>(first, last);
+	}
+#endif
+
+	template<typename InputIter, typename T>
+	inline T accumulate(InputIter first, InputIter last, T init)
+	{
+		return jan::__accumulate(first, last, init, typename __simd_traits<InputIter, T>::vectorizable());
+	}
+
 	template<typename InputIter, typename T, typename BinaryOp>
 	T accumulate(InputIter first, InputIter last, T init, const BinaryOp& binary_op)
 	{
 		for (; first != last; ++first)
 		{
-			init += binary_op(init, *first);
+			init = binary_op(init, *first);
 		}
-		return first;
+		return init;
 	}
 
-	template<typename InputIter, typename OutputIter>
-	OutputIter adjacent_difference(InputIter first, InputIter last, OutputIter res)
+	//op就是加法时与不带op的版本相同, 可以向量化
+	template<typename InputIter, typename T>
+	inline T accumulate(InputIter first, InputIter last, T init, const jan::plus<T>&)
 	{
-		if (first == last)
-			return res;
-		*res = *first;
-		while (++first != last)
-		{
-			*(++res) = *first - *(first - 1);
-		}
-		return ++res;
+		return jan::accumulate(first, last, init);
 	}
 
+	/**
+	 * @brief 相邻元素之差, res[0] = first[0], res[i] = binary_op(first[i], first[i - 1])
+	 *        上一个元素保存在局部变量里, 所以只需要输入迭代器, res也可以等于first
+	 *
+	 * @tparam InputIter
+	 * @tparam OutputIter
+	 * @tparam BinaryOp
+	 * @param first
+	 * @param last
+	 * @param res
+	 * @param binary_op
+	 * @return OutputIter
+	 */
 	template<typename InputIter, typename OutputIter, typename BinaryOp>
 	OutputIter adjacent_difference(InputIter first, InputIter last, OutputIter res, BinaryOp binary_op)
 	{
 		if (first == last)
 			return res;
-		*res = *first;
+		using value_type = typename iterator_traits<InputIter>::value_type;
+		value_type prev = *first;
+		*res = prev;
 		while (++first != last)
 		{
-			*(++res) = binary_op(*first, *(first - 1));
+			value_type cur = *first;
+			*(++res) = binary_op(cur, prev);
+			prev = std::move(cur);
 		}
 		return ++res;
 	}
 
+	template<typename InputIter, typename OutputIter>
+	inline OutputIter adjacent_difference(InputIter first, InputIter last, OutputIter res)
+	{
+		using value_type = typename iterator_traits<InputIter>::value_type;
+		return jan::adjacent_difference(first, last, res, jan::minus<value_type>());
+	}
+
 	template<typename InputIter1, typename InputIter2, typename T>
-	T inner_product(InputIter1 first1, InputIter1 last1, InputIter2 first2, T init)
+	T __inner_product(InputIter1 first1, InputIter1 last1, InputIter2 first2, T init, _false_type)
 	{
 		for (; first1 != last1; ++first1, ++first2)
 		{
@@ -68,6 +106,22 @@ namespace jan
 		return init;
 	}
 
+#ifdef __JAN_SIMD_X86
+	template<typename Ptr1, typename Ptr2, typename T>
+	inline T __inner_product(Ptr1 first1, Ptr1 last1, Ptr2 first2, T init, _true_type)
+	{
+		return init + jan::__simd_dot<T>(first1, last1, first2);
+	}
+#endif
+
+	template<typename InputIter1, typename InputIter2, typename T>
+	inline T inner_product(InputIter1 first1, InputIter1 last1, InputIter2 first2, T init)
+	{
+		typedef typename __tag_and<typename __simd_traits<InputIter1, T>::vectorizable,
+								   typename __simd_traits<InputIter2, T>::vectorizable>::type vectorizable;
+		return jan::__inner_product(first1, last1, first2, init, vectorizable());
+	}
+
 	template<typename InputIter1, typename InputIter2, typename T, typename BinaryOp>
 	T inner_product(InputIter1 first1, InputIter1 last1, InputIter2 first2, T init, BinaryOp binary_op)
 	{
@@ -78,34 +132,125 @@ namespace jan
 		return init;
 	}
 
-	template<typename InputIter, typename OutputIter>
-	OutputIter partial_sum(InputIter first, InputIter last, OutputIter res)
+	/**以下是前缀和一族函数, 并行版本在my_execution.h中**/
+
+	template<typename InputIter, typename OutputIter, typename BinaryOp, typename T>
+	OutputIter __inclusive_scan(InputIter first, InputIter last, OutputIter res, BinaryOp binary_op, T init, _false_type)
 	{
-		if (first == last)
-			return res;
-		using value_type = typename iterator_traits<InputIter>::value_type;
-		value_type val{};
-		for (; first != last; ++first)
+		for (; first != last; ++first, ++res)
+		{
+			init = binary_op(init, *first);
+			*res = init;
+		}
+		return res;
+	}
+
+	template<typename InputIter, typename OutputIter, typename BinaryOp, typename T>
+	OutputIter __exclusive_scan(InputIter first, InputIter last, OutputIter res, T init, BinaryOp binary_op, _false_type)
+	{
+		for (; first != last; ++first, ++res)
 		{
-			val += *first;
-			*res++ = val;
+			typename iterator_traits<InputIter>::value_type x = *first;
+			*res = init;
+			init = binary_op(init, x);
 		}
 		return res;
 	}
 
+#ifdef __JAN_SIMD_X86
+	template<typename Ptr, typename T>
+	inline T* __inclusive_scan(Ptr first, Ptr last, T* res, jan::plus<T>, T init, _true_type)
+	{
+		return jan::__simd_scan<T>(first, last, res, init, false);
+	}
+
+	template<typename Ptr, typename T>
+	inline T* __exclusive_scan(Ptr first, Ptr last, T* res, T init, jan::plus<T>, _true_type)
+	{
+		return jan::__simd_scan<T>(first, last, res, init, true);
+	}
+#endif
+
+	/**
+	 * @brief 包含当前元素的前缀和, res[i] = init op first[0] op ... op first[i]
+	 *        从左到右依次计算, 只需要输入迭代器, res可以等于first
+	 *        4/8字节整数的指针区间且op为jan::plus时使用寄存器内的向量扫描
+	 *
+	 * @tparam InputIter
+	 * @tparam OutputIter
+	 * @tparam BinaryOp
+	 * @tparam T
+	 * @param first
+	 * @param last
+	 * @param res
+	 * @param binary_op
+	 * @param init
+	 * @return OutputIter 写完后的res
+	 */
+	template<typename InputIter, typename OutputIter, typename BinaryOp, typename T>
+	inline OutputIter inclusive_scan(InputIter first, InputIter last, OutputIter res, BinaryOp binary_op, T init)
+	{
+		return jan::__inclusive_scan(first, last, res, binary_op, init,
+			typename __simd_scan_traits<InputIter, OutputIter, BinaryOp, T>::vectorizable());
+	}
+
+	//没有init时以第一个元素作为初值
 	template<typename InputIter, typename OutputIter, typename BinaryOp>
-	OutputIter partial_sum(InputIter first, InputIter last, OutputIter res, BinaryOp binary_op)
+	OutputIter inclusive_scan(InputIter first, InputIter last, OutputIter res, BinaryOp binary_op)
 	{
 		if (first == last)
 			return res;
+		typename iterator_traits<InputIter>::value_type init = *first;
+		*res = init;
+		return jan::inclusive_scan(++first, last, ++res, binary_op, init);
+	}
+
+	template<typename InputIter, typename OutputIter>
+	inline OutputIter inclusive_scan(InputIter first, InputIter last, OutputIter res)
+	{
 		using value_type = typename iterator_traits<InputIter>::value_type;
-		value_type val = *first;
-		for (; first != last;)
-		{
-			*res++ = val;
-			val = binary_op(val, *++first);
-		}
-		return res;
+		return jan::inclusive_scan(first, last, res, jan::plus<value_type>());
+	}
+
+	/**
+	 * @brief 不含当前元素的前缀和, res[0] = init, res[i] = init op first[0] op ... op first[i - 1]
+	 *        先读出first[i]再写res[i], 所以res可以等于first
+	 *
+	 * @tparam InputIter
+	 * @tparam OutputIter
+	 * @tparam T
+	 * @tparam BinaryOp
+	 * @param first
+	 * @param last
+	 * @param res
+	 * @param init
+	 * @param binary_op
+	 * @return OutputIter 写完后的res
+	 */
+	template<typename InputIter, typename OutputIter, typename T, typename BinaryOp>
+	inline OutputIter exclusive_scan(InputIter first, InputIter last, OutputIter res, T init, BinaryOp binary_op)
+	{
+		return jan::__exclusive_scan(first, last, res, init, binary_op,
+			typename __simd_scan_traits<InputIter, OutputIter, BinaryOp, T>::vectorizable());
+	}
+
+	template<typename InputIter, typename OutputIter, typename T>
+	inline OutputIter exclusive_scan(InputIter first, InputIter last, OutputIter res, T init)
+	{
+		return jan::exclusive_scan(first, last, res, init, jan::plus<T>());
+	}
+
+	//partial_sum就是不带init的inclusive_scan
+	template<typename InputIter, typename OutputIter>
+	inline OutputIter partial_sum(InputIter first, InputIter last, OutputIter res)
+	{
+		return jan::inclusive_scan(first, last, res);
+	}
+
+	template<typename InputIter, typename OutputIter, typename BinaryOp>
+	inline OutputIter partial_sum(InputIter first, InputIter last, OutputIter res, BinaryOp binary_op)
+	{
+		return jan::inclusive_scan(first, last, res, binary_op);
 	}
 
 	template<typename ForwardIter, typename T>
@@ -117,29 +262,18 @@ namespace jan
 		}
 	}
 
-	template<typename ForwardIter1, typename ForwardIter2>
-	void iter_swap(ForwardIter1 iter1, ForwardIter2 iter2)
+	template<typename T>
+	inline void swap(T& a, T& b)
 	{
-		using value_type = typename iterator_traits<ForwardIter1>::value_type;
-		value_type tmp = *iter1;
-		*iter1 = *iter2;
-		*iter2 = tmp;
+		T tmp = std::move(a);
+		a = std::move(b);
+		b = std::move(tmp);
 	}
 
-	template<typename InputIter1, typename InputIter2>
-	inline bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
-										InputIter2 first2, InputIter2 last2)
+	template<typename ForwardIter1, typename ForwardIter2>
+	void iter_swap(ForwardIter1 iter1, ForwardIter2 iter2)
 	{
-		for (; first1 != last1 && first2 != last2; ++first1, ++first2)
-		{
-			if (*first1 < *first2)
-				return true;
-			else if (*first1 > *first2)
-				return false;
-			else
-				continue;
-		}
-		return first1 == last1 && first2 != last2;
+		jan::swap(*iter1, *iter2);
 	}
 
 	template<typename T>
@@ -160,56 +294,204 @@ namespace jan
 		return a > b ? a : b;
 	}
 
-	inline bool lexicographical_compare(const unsigned char* first1,
-										const unsigned char* last1,
-										const unsigned char* first2,
-										const unsigned char* last2)
+	/**
+	 * @brief 字典序比较: 逐个比较到第一个不同的元素, 都相同时较短的区间在前
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam Compare 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @param comp 
+	 * @return [first1,last1)是否排在[first2,last2)前面
+	 */
+	template<typename InputIter1, typename InputIter2, typename Compare>
+	bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
+								 InputIter2 first2, InputIter2 last2, Compare comp)
 	{
-		const size_t len1 = last1 - first1;
-		const size_t len2 = last2 - first2;
-		int res = memcmp(first1, first2, min(len1, len2));
-		return res != 0 ? res < 0 : len1 < len2;
+		for (; first1 != last1 && first2 != last2; ++first1, ++first2)
+		{
+			if (comp(*first1, *first2))
+				return true;
+			if (comp(*first2, *first1))
+				return false;
+		}
+		return first1 == last1 && first2 != last2;
 	}
 
-	inline bool lexicographical_compare(const char* first1, const char* last1,
-										const char* first2, const char* last2)
+	template<typename InputIter1, typename InputIter2>
+	bool __lexicographical_compare(InputIter1 first1, InputIter1 last1,
+								   InputIter2 first2, InputIter2 last2, _false_type)
 	{
-		int res = strcmp(first1, first2);
-		return res <= 0 ? true : false;
+		for (; first1 != last1 && first2 != last2; ++first1, ++first2)
+		{
+			if (*first1 < *first2)
+				return true;
+			if (*first2 < *first1)
+				return false;
+		}
+		return first1 == last1 && first2 != last2;
 	}
 
-	template<typename T>
-	inline void swap(T& a, T& b)
+#ifdef __JAN_SIMD_X86
+	//按字节块找到第一个不同的元素, 只需要比较这一个元素
+	template<typename Ptr1, typename Ptr2>
+	inline bool __lexicographical_compare(Ptr1 first1, Ptr1 last1, Ptr2 first2, Ptr2 last2, _true_type)
 	{
-		T tmp = std::move(a);
-		a = std::move(b);
-		b = std::move(tmp);
+		const size_t len1 = last1 - first1, len2 = last2 - first2;
+		const size_t n = len1 < len2 ? len1 : len2;
+		const size_t i = jan::__simd_mismatch(first1, first2, n);
+		return i != n ? first1[i] < first2[i] : len1 < len2;
 	}
+#endif
 
+	/**
+	 * @brief 字典序比较, 两边是同一种整数的指针(如jan::vector<uint32_t>的迭代器)时
+	 *        按16/32字节块比较, 用movemask找到第一个不同的元素
+	 *        char按它自己的符号比较, 与逐个比较的结果一致
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @return [first1,last1)是否排在[first2,last2)前面
+	 */
 	template<typename InputIter1, typename InputIter2>
-	auto mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2) -> std::pair<InputIter1, InputIter2>
+	inline bool lexicographical_compare(InputIter1 first1, InputIter1 last1,
+										InputIter2 first2, InputIter2 last2)
 	{
-		for (; first1 != last1; ++first1, ++first2)
-		{
-			if (*first1 != *last1)
-				break;
-		}
+		return jan::__lexicographical_compare(first1, last1, first2, last2,
+			typename __simd_cmp_traits<InputIter1, InputIter2>::vectorizable());
+	}
+
+	/**
+	 * @brief 找到第一个使pred(*first1, *first2)为false的位置
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam BinaryPred 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 第二个区间至少与第一个一样长
+	 * @param pred 
+	 * @return 两个区间中第一对不匹配的元素, 都匹配时为{last1, first2 + (last1 - first1)}
+	 */
+	template<typename InputIter1, typename InputIter2, typename BinaryPred>
+	auto mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, BinaryPred pred) -> std::pair<InputIter1, InputIter2>
+	{
+		for (; first1 != last1 && pred(*first1, *first2); ++first1, ++first2)
+			;
 		return {first1, first2};
 	}
 
-	template<typename InputIter1, typename InputIter2, typename BinaryOp>
-	auto mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, BinaryOp binary_op) -> std::pair<InputIter1, InputIter2>
+	//两个区间都给出结尾, 比较到较短的区间结束为止
+	template<typename InputIter1, typename InputIter2, typename BinaryPred>
+	auto mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+				  BinaryPred pred) -> std::pair<InputIter1, InputIter2>
 	{
-		for (; first1 != last1; ++first1, ++first2)
-		{
-			if (binary_op(*first1, *first2))
-				break;
-		}
+		for (; first1 != last1 && first2 != last2 && pred(*first1, *first2); ++first1, ++first2)
+			;
 		return {first1, first2};
 	}
 
+	template<typename InputIter1, typename InputIter2>
+	auto __mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2,
+					_false_type) -> std::pair<InputIter1, InputIter2>
+	{
+		for (; first1 != last1 && *first1 == *first2; ++first1, ++first2)
+			;
+		return {first1, first2};
+	}
+
+	template<typename InputIter1, typename InputIter2>
+	auto __mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+					_false_type) -> std::pair<InputIter1, InputIter2>
+	{
+		for (; first1 != last1 && first2 != last2 && *first1 == *first2; ++first1, ++first2)
+			;
+		return {first1, first2};
+	}
+
+#ifdef __JAN_SIMD_X86
+	template<typename Ptr1, typename Ptr2>
+	inline auto __mismatch(Ptr1 first1, Ptr1 last1, Ptr2 first2, _true_type) -> std::pair<Ptr1, Ptr2>
+	{
+		const size_t i = jan::__simd_mismatch(first1, first2, last1 - first1);
+		return {first1 + i, first2 + i};
+	}
+
+	template<typename Ptr1, typename Ptr2>
+	inline auto __mismatch(Ptr1 first1, Ptr1 last1, Ptr2 first2, Ptr2 last2,
+						   _true_type) -> std::pair<Ptr1, Ptr2>
+	{
+		if (last2 - first2 < last1 - first1)
+			last1 = first1 + (last2 - first2);
+		return jan::__mismatch(first1, last1, first2, _true_type());
+	}
+#endif
+
+	/**
+	 * @brief 找到两个区间中第一对不相等的元素, 同一种整数的指针区间按16/32字节块比较
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 第二个区间至少与第一个一样长
+	 * @return 第一对不相等的元素, 都相等时为{last1, first2 + (last1 - first1)}
+	 */
+	template<typename InputIter1, typename InputIter2>
+	inline auto mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2) -> std::pair<InputIter1, InputIter2>
+	{
+		return jan::__mismatch(first1, last1, first2,
+			typename __simd_cmp_traits<InputIter1, InputIter2>::vectorizable());
+	}
+
+	//两个区间都给出结尾, 比较到较短的区间结束为止
+	template<typename InputIter1, typename InputIter2>
+	inline auto mismatch(InputIter1 first1, InputIter1 last1,
+						 InputIter2 first2, InputIter2 last2) -> std::pair<InputIter1, InputIter2>
+	{
+		return jan::__mismatch(first1, last1, first2, last2,
+			typename __simd_cmp_traits<InputIter1, InputIter2>::vectorizable());
+	}
+
 	/**以下是copy一族函数，应使用copy接口**/
 
+	/**
+ * @brief 按字节拷贝trivial的对象, 区间可以重叠
+ *        不少于streaming_threshold()字节并且两个区间不重叠时使用non-temporal写,
+ *        大块拷贝不会把正在使用的数据挤出缓存
+ * 
+ * @param res 
+ * @param first 
+ * @param bytes 
+ */
+	enum { __STREAM_MIN = 4096 };
+
+	inline void __copy_trivial(void* res, const void* first, size_t bytes)
+	{
+		//空区间的指针可能是nullptr, 传给memmove是未定义行为
+		if (bytes == 0)
+			return;
+#ifdef __JAN_SIMD_X86
+		const uintptr_t dst = reinterpret_cast<uintptr_t>(res);
+		const uintptr_t src = reinterpret_cast<uintptr_t>(first);
+		//先和一个固定的下限比较, 小块拷贝不必去读阈值
+		if (bytes >= __STREAM_MIN && bytes >= streaming_threshold() &&
+			(dst + bytes <= src || src + bytes <= dst))
+		{
+			jan::__simd_stream_copy(res, first, bytes);
+			return;
+		}
+#endif
+		memmove(res, first, bytes);
+	}
+
 	/**
  * @brief 用以c风格字符串的copy,这是一个最终版
  * 
@@ -220,10 +502,7 @@ namespace jan
  */
 	inline char* copy(const char* first, const char* last, char* res)
 	{
-		//char is one byte
-		std::cout << (last - first) << std::endl;
-		std::cin.get();
-		memmove(res, first, last - first);
+		jan::__copy_trivial(res, first, last - first);
 		return res + (last - first);
 	}
 
@@ -237,7 +516,7 @@ namespace jan
  */
 	inline wchar_t* copy(const wchar_t* first, const wchar_t* last, wchar_t* res)
 	{
-		memmove(res, first, sizeof(wchar_t) * (last - first));
+		jan::__copy_trivial(res, first, sizeof(wchar_t) * (last - first));
 		return res + (last - first);
 	}
 
@@ -274,8 +553,7 @@ namespace jan
 	template<typename T>
 	inline T* __copy_t(const T* first, const T* last, T* res, _true_type)
 	{
-		// std::cout << "[len:" << (last - first) << ":]" << std::endl;
-		memmove(res, first, sizeof(T) * (last - first));
+		jan::__copy_trivial(res, first, sizeof(T) * (last - first));
 		return res + (last - first);
 	}
 
@@ -385,254 +663,1989 @@ namespace jan
 		return __copy_dispatch<InputIter, OutputIter>()(first, last, res);
 	}
 
-	/**
-	 * @brief 集合的并集算法
-	 * 
-	 * @tparam InputIter 
-	 * @tparam OutputIter 
-	 * @param first1 
-	 * @param last1 
-	 * @param first2 
-	 * @param last2 
-	 * @param res 
-	 * @return OutputIter 
-	 */
-	template<typename InputIter1, typename InputIter2, typename OutputIter>
-	OutputIter set_union(InputIter1 first1, InputIter1 last1,
-								InputIter2 first2, InputIter2 last2,
-								OutputIter res)
+	template <typename InputIter, typename T>
+	typename iterator_traits<InputIter>::difference_type
+	__count(InputIter first, InputIter last, const T & val, _false_type)
 	{
-		while (first1 != last1 && first2 != last2)
-		{
-			if (*first1 < *first2)
-			{
-				*res = *first1;
-				++first1;
-			}
-			else if (*first2 < *first1)
-			{
-				*res = *first2;
-				++first2;
-			}
-			else
-			{
-				*res = *first1;
-				++first1;
-				++first2;
-			}
-			++res;
-		}
-		return jan::copy(first2,last2,jan::copy(first1,last1,res));
+		typename iterator_traits<InputIter>::difference_type ret = 0;
+		for(; first !=last; ++first)
+			if(*first == val)
+				++ret;
+		return ret;
 	}
 
-	/**
-	 * @brief 集合的差集算法
-	 * 
-	 * @tparam InputIter 
-	 * @tparam OutputIter 
-	 * @param first1 
-	 * @param last1 
-	 * @param first2 
-	 * @param last2 
-	 * @param res 
-	 * @return OutputIter 
+#ifdef __JAN_SIMD_X86
+	template <typename Ptr, typename T>
+	inline ptrdiff_t __count(Ptr first, Ptr last, const T & val, _true_type)
+	{
+		return static_cast<ptrdiff_t>(jan::__simd_count<T>(first, last, val));
+	}
+#endif
+
+	template <typename InputIter, typename T>
+	inline typename iterator_traits<InputIter>::difference_type
+	count(InputIter first, InputIter last, const T & val)
+	{
+		return jan::__count(first, last, val, typename __simd_traits<InputIter, T>::vectorizable());
+	}
+
+	template <typename InputIter, typename Predicate>
+	typename iterator_traits<InputIter>::difference_type
+	count_if(InputIter first, InputIter last, Predicate pred)
+	{
+		typename iterator_traits<InputIter>::difference_type ret = 0;
+		for(; first != last; ++first)
+			if(pred(*first))
+				++ret;
+		return ret;
+	}
+
+	template <typename ForwardIter>
+	ForwardIter adjacent_find(ForwardIter first, ForwardIter last)
+	{
+		ForwardIter next = first;
+		++next;
+		while (next != last)
+		{
+			if(*next == *first)
+				return first;
+			++first;
+			++next;
+		}
+		return last;
+	}
+
+	template <typename ForwardIter, typename BinaryPredicate>
+	ForwardIter adjacent_find(ForwardIter first, ForwardIter last, BinaryPredicate bin_pred)
+	{
+		ForwardIter next = first;
+		++next;
+		while (next != last)
+		{
+			if(bin_pred(*first,*next))
+				return first;
+			++first;
+			++next;
+		}
+		return last;
+	}
+	
+	template <typename InputIter, typename T>
+	InputIter __find(InputIter first, InputIter last, const T & val, _false_type)
+	{
+		while (first != last)
+		{
+			if(*first == val)
+				return first;
+			++first;
+		}
+		return last;
+	}
+
+#ifdef __JAN_SIMD_X86
+	template <typename Ptr, typename T>
+	inline Ptr __find(Ptr first, Ptr last, const T & val, _true_type)
+	{
+		return first + (jan::__simd_find<T>(first, last, val) - first);
+	}
+#endif
+
+	template <typename InputIter, typename T>
+	inline InputIter find(InputIter first, InputIter last, const T & val)
+	{
+		return jan::__find(first, last, val, typename __simd_traits<InputIter, T>::vectorizable());
+	}
+
+	template <typename InputIter, typename Predicate>
+	InputIter find_if(InputIter first, InputIter last, Predicate pred)
+	{
+		while (first != last)
+		{
+			if(pred(*first))
+				return first;
+			++first;
+		}
+		return last;
+	}
+
+	template <typename InputIter, typename F>
+	F for_each(InputIter first, InputIter last, F f)
+	{
+		while (first != last)
+		{
+			f(*first);
+			++first;
+		}
+		return f;
+	}
+
+
+	/************sort***********/
+	//区间长度不超过此值时交给插入排序
+	enum { __SORT_THRESHOLD = 16 };
+	//区间长度超过此值时用九数取中(ninther)选择枢轴, 否则用三数取中
+	enum { __NINTHER_THRESHOLD = 128 };
+
+	/**
+	 * @brief 将last处的元素向前插入到合适的位置, 调用者保证前面一定有不大于它的元素, 所以不检查边界
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	void __unguarded_linear_insert(RandomIter last, Compare comp)
+	{
+		typename iterator_traits<RandomIter>::value_type val = std::move(*last);
+		RandomIter next = last;
+		--next;
+		while (comp(val, *next))
+		{
+			*last = std::move(*next);
+			last = next;
+			--next;
+		}
+		*last = std::move(val);
+	}
+
+	template <typename RandomIter, typename Compare>
+	void __insertion_sort(RandomIter first, RandomIter last, Compare comp)
+	{
+		if(first == last)
+			return;
+		for(RandomIter i = first + 1; i != last; ++i)
+		{
+			if(comp(*i, *first))
+			{
+				//比首元素还小, 整体后移一位后放到最前面
+				typename iterator_traits<RandomIter>::value_type val = std::move(*i);
+				for(RandomIter j = i; j != first; --j)
+					*j = std::move(*(j - 1));
+				*first = std::move(val);
+			}
+			else
+				jan::__unguarded_linear_insert(i, comp);
+		}
+	}
+
+	template <typename RandomIter, typename Compare>
+	inline void __unguarded_insertion_sort(RandomIter first, RandomIter last, Compare comp)
+	{
+		for(RandomIter i = first; i != last; ++i)
+			jan::__unguarded_linear_insert(i, comp);
+	}
+
+	/**
+	 * @brief introsort结束后每一段都不超过__SORT_THRESHOLD个元素, 并且段与段之间已经有序,
+	 *        前__SORT_THRESHOLD个元素中一定有全局最小值, 之后的插入不需要检查边界
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	void __final_insertion_sort(RandomIter first, RandomIter last, Compare comp)
+	{
+		if(last - first > __SORT_THRESHOLD)
+		{
+			jan::__insertion_sort(first, first + __SORT_THRESHOLD, comp);
+			jan::__unguarded_insertion_sort(first + __SORT_THRESHOLD, last, comp);
+		}
+		else
+			jan::__insertion_sort(first, last, comp);
+	}
+
+	template <typename RandomIter, typename Compare>
+	inline RandomIter __median(RandomIter a, RandomIter b, RandomIter c, Compare comp)
+	{
+		if(comp(*a, *b))
+		{
+			if(comp(*b, *c))
+				return b;
+			return comp(*a, *c) ? c : a;
+		}
+		if(comp(*a, *c))
+			return a;
+		return comp(*b, *c) ? c : b;
+	}
+
+	/**
+	 * @brief 从[first,last)中取中(长区间用九数取中)作为枢轴, 换到*first
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	void __move_pivot_to_first(RandomIter first, RandomIter last, Compare comp)
+	{
+		using Distance = typename iterator_traits<RandomIter>::difference_type;
+		const Distance len = last - first;
+		RandomIter mid = first + len / 2;
+		RandomIter pivot;
+		if(len > __NINTHER_THRESHOLD)
+		{
+			const Distance s = len / 8;
+			pivot = jan::__median(jan::__median(first + 1, first + s, first + 2 * s, comp),
+								  jan::__median(mid - s, mid, mid + s, comp),
+								  jan::__median(last - 1 - 2 * s, last - 1 - s, last - 1, comp),
+								  comp);
+		}
+		else
+			pivot = jan::__median(first + 1, mid, last - 1, comp);
+		jan::iter_swap(first, pivot);
+	}
+
+	/**
+	 * @brief 以*first为枢轴划分[first+1,last), 返回右半部分的起点, 左边都不大于枢轴, 右边都不小于枢轴
+	 *        枢轴是从区间内取中得到的, 左右两边一定各有一个元素能让扫描停下, 所以不检查边界
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 * @return RandomIter 
+	 */
+	template <typename RandomIter, typename Compare>
+	RandomIter __unguarded_partition(RandomIter first, RandomIter last, Compare comp)
+	{
+		RandomIter left = first + 1;
+		RandomIter right = last;
+		while (true)
+		{
+			while (comp(*left, *first))
+				++left;
+			--right;
+			while (comp(*first, *right))
+				--right;
+			if(!(left < right))
+				return left;
+			jan::iter_swap(left, right);
+			++left;
+		}
+	}
+
+	template <typename RandomIter, typename Compare>
+	inline RandomIter __unguarded_partition_pivot(RandomIter first, RandomIter last, Compare comp)
+	{
+		jan::__move_pivot_to_first(first, last, comp);
+		return jan::__unguarded_partition(first, last, comp);
+	}
+
+	/**
+	 * @brief 以*first为枢轴划分, 不大于枢轴的放在左边, 大于枢轴的放在右边, 枢轴放到两部分之间并返回它的位置
+	 *        只在区间前一个元素等于枢轴时使用: 此时区间内没有比枢轴小的元素,
+	 *        [first, 返回值]全部等于枢轴, 已经在最终位置上, 之后只需处理右边
+	 *        从右往左的扫描总会停在*first上; 右边存在大于枢轴的元素时, 从左往右的扫描不需要检查边界
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 * @return RandomIter 
+	 */
+	template <typename RandomIter, typename Compare>
+	RandomIter __partition_equal_left(RandomIter first, RandomIter last, Compare comp)
+	{
+		RandomIter left = first;
+		RandomIter right = last;
+		while (comp(*first, *--right))
+			;
+		if(right + 1 == last)
+			while (left < right && !comp(*first, *++left))
+				;
+		else
+			while (!comp(*first, *++left))
+				;
+		while (left < right)
+		{
+			jan::iter_swap(left, right);
+			while (comp(*first, *--right))
+				;
+			while (!comp(*first, *++left))
+				;
+		}
+		jan::iter_swap(first, right);
+		return right;
+	}
+
+	/**
+	 * @brief 快速排序, 只处理长度超过__SORT_THRESHOLD的区间, 剩下的留给最后的插入排序
+	 *        递归深度超过depth_limit说明枢轴选得很差, 改用堆排序保证O(nlogn)
+	 *        leftmost为false时*(first - 1)不大于区间内的任何元素; 枢轴与它相等说明区间内有很多等于枢轴的元素,
+	 *        这时把等于枢轴的元素都划分到左边直接跳过, 重复元素很多的输入上接近O(n * 不同的值的个数)
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Size 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param depth_limit 
+	 * @param comp 
+	 * @param leftmost 
+	 */
+	template <typename RandomIter, typename Size, typename Compare>
+	void __introsort_loop(RandomIter first, RandomIter last, Size depth_limit, Compare comp, bool leftmost)
+	{
+		while (last - first > __SORT_THRESHOLD)
+		{
+			if(depth_limit == 0)
+			{
+				jan::make_heap(first, last, comp);
+				jan::sort_heap(first, last, comp);
+				return;
+			}
+			--depth_limit;
+			jan::__move_pivot_to_first(first, last, comp);
+			if(!leftmost && !comp(*(first - 1), *first))
+			{
+				first = jan::__partition_equal_left(first, last, comp) + 1;
+				continue;
+			}
+			RandomIter cut = jan::__unguarded_partition(first, last, comp);
+			//对右半部分递归, 左半部分在循环中处理, *(cut - 1)不大于右半部分的任何元素
+			jan::__introsort_loop(cut, last, depth_limit, comp, false);
+			last = cut;
+		}
+	}
+
+	/**
+	 * @brief 内省排序(introsort), 不稳定
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	inline void sort(RandomIter first, RandomIter last, Compare comp)
+	{
+		if(last - first < 2)
+			return;
+		size_t depth_limit = 0;
+		for(auto n = last - first; n > 1; n >>= 1)
+			depth_limit += 2;
+		jan::__introsort_loop(first, last, depth_limit, comp, true);
+		jan::__final_insertion_sort(first, last, comp);
+	}
+
+	template <typename RandomIter>
+	inline void sort(RandomIter first, RandomIter last)
+	{
+		using T = typename iterator_traits<RandomIter>::value_type;
+		jan::sort(first, last, jan::less<T>());
+	}
+
+	/************nth_element / partial_sort***********/
+
+	/**
+	 * @brief 在[first,middle)上建一个按comp的大根堆, 把[middle,last)中比堆顶小的元素换进来,
+	 *        结束后[first,middle)是最小的middle-first个元素, 堆顶是其中最大的一个
+	 *        要求first != middle
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param middle 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	void __heap_select(RandomIter first, RandomIter middle, RandomIter last, Compare comp)
+	{
+		using Distance = typename iterator_traits<RandomIter>::difference_type;
+		using T = typename iterator_traits<RandomIter>::value_type;
+		jan::make_heap(first, middle, comp);
+		const Distance len = middle - first;
+		for(RandomIter i = middle; i < last; ++i)
+		{
+			if(comp(*i, *first))
+			{
+				//堆顶换到i处, *i从根开始下沉
+				T val = std::move(*i);
+				*i = std::move(*first);
+				jan::__adjust_heap<2>(first, Distance(0), len, std::move(val), comp);
+			}
+		}
+	}
+
+	/**
+	 * @brief 把最小的middle-first个元素按顺序放到[first,middle), 其余元素的顺序不确定
+	 *        堆选择的代价约为(last-first)*log(k), k远小于n时比整体排序快得多
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param middle 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	inline void partial_sort(RandomIter first, RandomIter middle, RandomIter last, Compare comp)
+	{
+		if(first == middle)
+			return;
+		jan::__heap_select(first, middle, last, comp);
+		jan::sort_heap(first, middle, comp);
+	}
+
+	template <typename RandomIter>
+	inline void partial_sort(RandomIter first, RandomIter middle, RandomIter last)
+	{
+		using T = typename iterator_traits<RandomIter>::value_type;
+		jan::partial_sort(first, middle, last, jan::less<T>());
+	}
+
+	/**
+	 * @brief 把[first,last)中最小的min(n, res_last-res_first)个元素按顺序拷贝到res_first开始的区间
+	 *        只需要输入迭代器, 输入只读一遍; 结果区间先当作大根堆, 比堆顶小的元素替换堆顶后下沉
+	 * 
+	 * @tparam InputIter 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param res_first 
+	 * @param res_last 
+	 * @param comp 
+	 * @return RandomIter 写入的最后一个元素之后的位置
+	 */
+	template <typename InputIter, typename RandomIter, typename Compare>
+	RandomIter partial_sort_copy(InputIter first, InputIter last, RandomIter res_first, RandomIter res_last,
+								 Compare comp)
+	{
+		using Distance = typename iterator_traits<RandomIter>::difference_type;
+		using T = typename iterator_traits<RandomIter>::value_type;
+		RandomIter res_end = res_first;
+		for(; first != last && res_end != res_last; ++first, ++res_end)
+			*res_end = *first;
+		if(res_end == res_first)
+			return res_end;
+		jan::make_heap(res_first, res_end, comp);
+		const Distance len = res_end - res_first;
+		for(; first != last; ++first)
+		{
+			if(comp(*first, *res_first))
+				jan::__adjust_heap<2>(res_first, Distance(0), len, T(*first), comp);
+		}
+		jan::sort_heap(res_first, res_end, comp);
+		return res_end;
+	}
+
+	template <typename InputIter, typename RandomIter>
+	inline RandomIter partial_sort_copy(InputIter first, InputIter last, RandomIter res_first, RandomIter res_last)
+	{
+		using T = typename iterator_traits<RandomIter>::value_type;
+		return jan::partial_sort_copy(first, last, res_first, res_last, jan::less<T>());
+	}
+
+	/**
+	 * @brief 内省选择: 与introsort一样划分, 但只继续处理包含nth的一边, 期望O(n)
+	 *        划分次数超过depth_limit时改用堆选择, 最坏O(nlogn)
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Size 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param nth 
+	 * @param last 
+	 * @param depth_limit 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Size, typename Compare>
+	void __introselect(RandomIter first, RandomIter nth, RandomIter last, Size depth_limit, Compare comp)
+	{
+		while (last - first > 3)
+		{
+			if(depth_limit == 0)
+			{
+				//[first,nth]成为最小的一批元素, 堆顶就是第nth个
+				jan::__heap_select(first, nth + 1, last, comp);
+				jan::iter_swap(first, nth);
+				return;
+			}
+			--depth_limit;
+			RandomIter cut = jan::__unguarded_partition_pivot(first, last, comp);
+			if(cut <= nth)
+				first = cut;
+			else
+				last = cut;
+		}
+		jan::__insertion_sort(first, last, comp);
+	}
+
+	/**
+	 * @brief 重排[first,last), 使*nth是整体排序后应在该位置的元素,
+	 *        [first,nth)中的元素都不大于它, (nth,last)中的元素都不小于它
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param nth 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	inline void nth_element(RandomIter first, RandomIter nth, RandomIter last, Compare comp)
+	{
+		if(first == last || nth == last)
+			return;
+		size_t depth_limit = 0;
+		for(auto n = last - first; n > 1; n >>= 1)
+			depth_limit += 2;
+		jan::__introselect(first, nth, last, depth_limit, comp);
+	}
+
+	template <typename RandomIter>
+	inline void nth_element(RandomIter first, RandomIter nth, RandomIter last)
+	{
+		using T = typename iterator_traits<RandomIter>::value_type;
+		jan::nth_element(first, nth, last, jan::less<T>());
+	}
+
+	/************merge / rotate / binary search***********/
+	template <typename BidirectionalIter>
+	void reverse(BidirectionalIter first, BidirectionalIter last)
+	{
+		while (first != last && first != --last)
+		{
+			jan::iter_swap(first, last);
+			++first;
+		}
+	}
+
+	/**
+	 * @brief 将[middle,last)移到[first,middle)之前, 返回原来的*first现在所在的位置
+	 *        每次把前一段与等长的后一段交换, 只需要前向迭代器
+	 * 
+	 * @tparam ForwardIter 
+	 * @param first 
+	 * @param middle 
+	 * @param last 
+	 * @return ForwardIter 
+	 */
+	template <typename ForwardIter>
+	ForwardIter rotate(ForwardIter first, ForwardIter middle, ForwardIter last)
+	{
+		if(first == middle)
+			return last;
+		if(middle == last)
+			return first;
+		ForwardIter next = middle;
+		do
+		{
+			jan::iter_swap(first++, next++);
+			if(first == middle)
+				middle = next;
+		} while (next != last);
+		ForwardIter ret = first;
+		next = middle;
+		while (next != last)
+		{
+			jan::iter_swap(first++, next++);
+			if(first == middle)
+				middle = next;
+			else if(next == last)
+				next = middle;
+		}
+		return ret;
+	}
+
+	template <typename ForwardIter, typename T, typename Compare>
+	ForwardIter __lower_bound(ForwardIter first, ForwardIter last, const T & val, Compare comp, forward_iterator_tag)
+	{
+		auto len = jan::distance(first, last);
+		while (len > 0)
+		{
+			auto half = len / 2;
+			ForwardIter mid = first;
+			jan::advance(mid, half);
+			if(comp(*mid, val))
+			{
+				first = ++mid;
+				len -= half + 1;
+			}
+			else
+				len = half;
+		}
+		return first;
+	}
+
+	//预取迭代器指向的元素, 只对原生指针有效, 其它迭代器什么也不做
+	template <typename Iter>
+	inline void __prefetch(Iter) { }
+
+	template <typename T>
+	inline void __prefetch(T* p)
+	{
+#if defined(__GNUC__)
+		__builtin_prefetch(p);
+#endif
+	}
+
+	/**
+	 * @brief 随机访问迭代器上的无分支二分: 答案始终在[first, first + len]中,
+	 *        每轮只根据比较结果决定first是否前进half, 编译器可以生成条件传送,
+	 *        大数组上不会因为分支预测失败而清空流水线, 循环次数也与val无关
+	 *        没有分支就没有推测执行带来的预读, 所以把下一轮可能的两个中点都预取进来
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param val 
+	 * @param comp 
+	 * @return RandomIter 
+	 */
+	template <typename RandomIter, typename T, typename Compare>
+	RandomIter __lower_bound(RandomIter first, RandomIter last, const T & val, Compare comp, random_access_iterator_tag)
+	{
+		auto len = last - first;
+		if(len == 0)
+			return first;
+		while (len > 1)
+		{
+			auto half = len / 2;
+			jan::__prefetch(first + (len - half) / 2);
+			jan::__prefetch(first + half + (len - half) / 2);
+			first = comp(*(first + half), val) ? first + half : first;
+			len -= half;
+		}
+		return comp(*first, val) ? first + 1 : first;
+	}
+
+	/**
+	 * @brief 返回有序区间中第一个不小于val的位置
+	 * 
+	 * @tparam ForwardIter 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param val 
+	 * @param comp 
+	 * @return ForwardIter 
+	 */
+	template <typename ForwardIter, typename T, typename Compare>
+	inline ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T & val, Compare comp)
+	{
+		return jan::__lower_bound(first, last, val, comp,
+			typename iterator_traits<ForwardIter>::iterator_category());
+	}
+
+	template <typename ForwardIter, typename T>
+	inline ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T & val)
+	{
+		return jan::lower_bound(first, last, val, jan::less<T>());
+	}
+
+	template <typename ForwardIter, typename T, typename Compare>
+	ForwardIter __upper_bound(ForwardIter first, ForwardIter last, const T & val, Compare comp, forward_iterator_tag)
+	{
+		auto len = jan::distance(first, last);
+		while (len > 0)
+		{
+			auto half = len / 2;
+			ForwardIter mid = first;
+			jan::advance(mid, half);
+			if(comp(val, *mid))
+				len = half;
+			else
+			{
+				first = ++mid;
+				len -= half + 1;
+			}
+		}
+		return first;
+	}
+
+	template <typename RandomIter, typename T, typename Compare>
+	RandomIter __upper_bound(RandomIter first, RandomIter last, const T & val, Compare comp, random_access_iterator_tag)
+	{
+		auto len = last - first;
+		if(len == 0)
+			return first;
+		while (len > 1)
+		{
+			auto half = len / 2;
+			jan::__prefetch(first + (len - half) / 2);
+			jan::__prefetch(first + half + (len - half) / 2);
+			first = comp(val, *(first + half)) ? first : first + half;
+			len -= half;
+		}
+		return comp(val, *first) ? first : first + 1;
+	}
+
+	/**
+	 * @brief 返回有序区间中第一个大于val的位置
+	 * 
+	 * @tparam ForwardIter 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param val 
+	 * @param comp 
+	 * @return ForwardIter 
+	 */
+	template <typename ForwardIter, typename T, typename Compare>
+	inline ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T & val, Compare comp)
+	{
+		return jan::__upper_bound(first, last, val, comp,
+			typename iterator_traits<ForwardIter>::iterator_category());
+	}
+
+	template <typename ForwardIter, typename T>
+	inline ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T & val)
+	{
+		return jan::upper_bound(first, last, val, jan::less<T>());
+	}
+
+	/**
+	 * @brief 有序区间中是否有与val等价的元素
+	 * 
+	 * @tparam ForwardIter 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param val 
+	 * @param comp 
+	 * @return bool 
+	 */
+	template <typename ForwardIter, typename T, typename Compare>
+	inline bool binary_search(ForwardIter first, ForwardIter last, const T & val, Compare comp)
+	{
+		first = jan::lower_bound(first, last, val, comp);
+		return first != last && !comp(val, *first);
+	}
+
+	template <typename ForwardIter, typename T>
+	inline bool binary_search(ForwardIter first, ForwardIter last, const T & val)
+	{
+		return jan::binary_search(first, last, val, jan::less<T>());
+	}
+
+	/**
+	 * @brief 与val等价的元素组成的子区间[lower_bound, upper_bound)
+	 *        先二分到第一个与val等价的元素, 再在两边的剩余区间里分别找上下界
+	 * 
+	 * @tparam ForwardIter 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param val 
+	 * @param comp 
+	 * @return std::pair<ForwardIter, ForwardIter> 
+	 */
+	template <typename ForwardIter, typename T, typename Compare>
+	std::pair<ForwardIter, ForwardIter> equal_range(ForwardIter first, ForwardIter last, const T & val, Compare comp)
+	{
+		auto len = jan::distance(first, last);
+		while (len > 0)
+		{
+			auto half = len / 2;
+			ForwardIter mid = first;
+			jan::advance(mid, half);
+			if(comp(*mid, val))
+			{
+				first = ++mid;
+				len -= half + 1;
+			}
+			else if(comp(val, *mid))
+				len = half;
+			else
+			{
+				ForwardIter left = jan::lower_bound(first, mid, val, comp);
+				jan::advance(first, len);
+				ForwardIter right = jan::upper_bound(++mid, first, val, comp);
+				return std::pair<ForwardIter, ForwardIter>(left, right);
+			}
+		}
+		return std::pair<ForwardIter, ForwardIter>(first, first);
+	}
+
+	template <typename ForwardIter, typename T>
+	inline std::pair<ForwardIter, ForwardIter> equal_range(ForwardIter first, ForwardIter last, const T & val)
+	{
+		return jan::equal_range(first, last, val, jan::less<T>());
+	}
+
+	/**以下是有序区间上的集合算法, 元素可以重复(多重集合)**/
+
+	//两个区间的长度相差__GALLOP_RATIO倍以上时, 对短区间的每个元素在长区间中倍增查找
+	enum { __GALLOP_RATIO = 16 };
+
+	/**
+	 * @brief 倍增查找第一个不小于val的位置: 依次探测first[1], first[3], first[7]...,
+	 *        跨过val后在最后一段中二分; 结果离first为d时只需要O(log d)次比较
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param val 
+	 * @param comp 
+	 * @return RandomIter 
+	 */
+	template <typename RandomIter, typename T, typename Compare>
+	RandomIter __gallop_lower_bound(RandomIter first, RandomIter last, const T & val, Compare comp)
+	{
+		typedef typename iterator_traits<RandomIter>::difference_type Distance;
+		const Distance len = last - first;
+		if (len == 0 || !comp(*first, val))
+			return first;
+		Distance lo = 0, hi = 1;
+		while (hi < len && comp(first[hi], val))
+		{
+			lo = hi;
+			hi = 2 * hi + 1;
+		}
+		if (hi > len)
+			hi = len;
+		return jan::lower_bound(first + lo + 1, first + hi, val, comp);
+	}
+
+	//返回1表示对第一个区间的元素倍增查找第二个区间, 2则相反, 0表示长度接近, 逐个归并
+	template <typename Distance>
+	inline int __gallop_side(Distance len1, Distance len2)
+	{
+		if (len1 * __GALLOP_RATIO <= len2)
+			return 1;
+		if (len2 * __GALLOP_RATIO <= len1)
+			return 2;
+		return 0;
+	}
+
+	//两个迭代器都是随机访问迭代器时才能倍增查找
+	template <typename Category1, typename Category2>
+	struct __set_category
+	{
+		typedef input_iterator_tag type;
+	};
+
+	template <>
+	struct __set_category<random_access_iterator_tag, random_access_iterator_tag>
+	{
+		typedef random_access_iterator_tag type;
+	};
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	OutputIter __set_union(InputIter1 first1, InputIter1 last1,
+						   InputIter2 first2, InputIter2 last2,
+						   OutputIter res, Compare comp, input_iterator_tag)
+	{
+		while (first1 != last1 && first2 != last2)
+		{
+			if (comp(*first1, *first2))
+			{
+				*res = *first1;
+				++first1;
+			}
+			else if (comp(*first2, *first1))
+			{
+				*res = *first2;
+				++first2;
+			}
+			else
+			{
+				*res = *first1;
+				++first1;
+				++first2;
+			}
+			++res;
+		}
+		return jan::copy(first2,last2,jan::copy(first1,last1,res));
+	}
+
+	template<typename RandomIter1, typename RandomIter2, typename OutputIter, typename Compare>
+	OutputIter __set_union(RandomIter1 first1, RandomIter1 last1,
+						   RandomIter2 first2, RandomIter2 last2,
+						   OutputIter res, Compare comp, random_access_iterator_tag)
+	{
+		switch (jan::__gallop_side(last1 - first1, last2 - first2))
+		{
+		case 1:
+			for (; first1 != last1; ++first1, ++res)
+			{
+				RandomIter2 pos = jan::__gallop_lower_bound(first2, last2, *first1, comp);
+				res = jan::copy(first2, pos, res);
+				first2 = pos;
+				if (first2 != last2 && !comp(*first1, *first2))
+					++first2;
+				*res = *first1;
+			}
+			return jan::copy(first2, last2, res);
+		case 2:
+			for (; first2 != last2; ++first2, ++res)
+			{
+				RandomIter1 pos = jan::__gallop_lower_bound(first1, last1, *first2, comp);
+				res = jan::copy(first1, pos, res);
+				first1 = pos;
+				if (first1 != last1 && !comp(*first2, *first1))
+				{
+					*res = *first1;
+					++first1;
+				}
+				else
+					*res = *first2;
+			}
+			return jan::copy(first1, last1, res);
+		default:
+			return jan::__set_union(first1, last1, first2, last2, res, comp, input_iterator_tag());
+		}
+	}
+
+	/**
+	 * @brief 集合的并集算法, 相等的元素取自第一个区间
+	 *        两个区间都可随机访问并且长度相差很大时, 用倍增查找跳过长区间中的一段, 整段拷贝
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam OutputIter 
+	 * @tparam Compare 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @param res 
+	 * @param comp 
+	 * @return OutputIter 
+	 */
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	inline OutputIter set_union(InputIter1 first1, InputIter1 last1,
+								InputIter2 first2, InputIter2 last2,
+								OutputIter res, Compare comp)
+	{
+		typedef typename __set_category<typename iterator_traits<InputIter1>::iterator_category,
+										typename iterator_traits<InputIter2>::iterator_category>::type category;
+		return jan::__set_union(first1, last1, first2, last2, res, comp, category());
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter set_union(InputIter1 first1, InputIter1 last1,
+								InputIter2 first2, InputIter2 last2,
+								OutputIter res)
+	{
+		return jan::set_union(first1, last1, first2, last2, res,
+							  jan::less<typename iterator_traits<InputIter1>::value_type>());
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	OutputIter __set_difference(InputIter1 first1, InputIter1 last1,
+								InputIter2 first2, InputIter2 last2,
+								OutputIter res, Compare comp, input_iterator_tag)
+	{
+		while (first1 != last1 && first2 != last2)
+		{
+			if (comp(*first2, *first1))
+				++first2;
+			else if (comp(*first1, *first2))
+			{
+				*res = *first1;
+				++res;
+				++first1;
+			}
+			else
+			{
+				++first1;
+				++first2;
+			}
+		}
+		return jan::copy(first1, last1, res);
+	}
+
+	template<typename RandomIter1, typename RandomIter2, typename OutputIter, typename Compare>
+	OutputIter __set_difference(RandomIter1 first1, RandomIter1 last1,
+								RandomIter2 first2, RandomIter2 last2,
+								OutputIter res, Compare comp, random_access_iterator_tag)
+	{
+		switch (jan::__gallop_side(last1 - first1, last2 - first2))
+		{
+		case 1:
+			for (; first1 != last1; ++first1)
+			{
+				first2 = jan::__gallop_lower_bound(first2, last2, *first1, comp);
+				if (first2 != last2 && !comp(*first1, *first2))
+					++first2;
+				else
+				{
+					*res = *first1;
+					++res;
+				}
+			}
+			return res;
+		case 2:
+			for (; first2 != last2; ++first2)
+			{
+				RandomIter1 pos = jan::__gallop_lower_bound(first1, last1, *first2, comp);
+				res = jan::copy(first1, pos, res);
+				first1 = pos;
+				if (first1 != last1 && !comp(*first2, *first1))
+					++first1;
+			}
+			return jan::copy(first1, last1, res);
+		default:
+			return jan::__set_difference(first1, last1, first2, last2, res, comp, input_iterator_tag());
+		}
+	}
+
+	/**
+	 * @brief 集合的差集算法, 输出在第一个区间中而不在第二个区间中的元素
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam OutputIter 
+	 * @tparam Compare 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @param res 
+	 * @param comp 
+	 * @return OutputIter 
+	 */
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	inline OutputIter set_difference(InputIter1 first1, InputIter1 last1,
+									 InputIter2 first2, InputIter2 last2,
+									 OutputIter res, Compare comp)
+	{
+		typedef typename __set_category<typename iterator_traits<InputIter1>::iterator_category,
+										typename iterator_traits<InputIter2>::iterator_category>::type category;
+		return jan::__set_difference(first1, last1, first2, last2, res, comp, category());
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter set_difference(InputIter1 first1, InputIter1 last1,
+									 InputIter2 first2, InputIter2 last2,
+									 OutputIter res)
+	{
+		return jan::set_difference(first1, last1, first2, last2, res,
+								   jan::less<typename iterator_traits<InputIter1>::value_type>());
+	}
+
+	//旧的拼写, 保留给已有的调用者
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter set_diffrence(InputIter1 first1, InputIter1 last1,
+									InputIter2 first2, InputIter2 last2,
+									OutputIter res)
+	{
+		return jan::set_difference(first1, last1, first2, last2, res);
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	OutputIter __set_intersection(InputIter1 first1, InputIter1 last1,
+								  InputIter2 first2, InputIter2 last2,
+								  OutputIter res, Compare comp, input_iterator_tag)
+	{
+		while (first1 != last1 && first2 != last2)
+		{
+			if (comp(*first1, *first2))
+				++first1;
+			else if (comp(*first2, *first1))
+				++first2;
+			else
+			{
+				*res = *first1;
+				++first1;
+				++first2;
+				++res;
+			}
+		}
+		return res;
+	}
+
+	template<typename RandomIter1, typename RandomIter2, typename OutputIter, typename Compare>
+	OutputIter __set_intersection(RandomIter1 first1, RandomIter1 last1,
+								  RandomIter2 first2, RandomIter2 last2,
+								  OutputIter res, Compare comp, random_access_iterator_tag)
+	{
+		switch (jan::__gallop_side(last1 - first1, last2 - first2))
+		{
+		case 1:
+			for (; first1 != last1; ++first1)
+			{
+				first2 = jan::__gallop_lower_bound(first2, last2, *first1, comp);
+				if (first2 == last2)
+					break;
+				if (!comp(*first1, *first2))
+				{
+					*res = *first1;
+					++res;
+					++first2;
+				}
+			}
+			return res;
+		case 2:
+			for (; first2 != last2; ++first2)
+			{
+				first1 = jan::__gallop_lower_bound(first1, last1, *first2, comp);
+				if (first1 == last1)
+					break;
+				if (!comp(*first2, *first1))
+				{
+					*res = *first1;
+					++res;
+					++first1;
+				}
+			}
+			return res;
+		default:
+			return jan::__set_intersection(first1, last1, first2, last2, res, comp, input_iterator_tag());
+		}
+	}
+
+	/**
+	 * @brief 集合的交集算法, 结果取自第一个区间
+	 *        长度相差很大时(如1k与10M)对短区间的每个元素在长区间中倍增查找, 复杂度约为O(m log(n/m))
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam OutputIter 
+	 * @tparam Compare 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @param res 
+	 * @param comp 
+	 * @return OutputIter 
+	 */
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	inline OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
+									   InputIter2 first2, InputIter2 last2,
+									   OutputIter res, Compare comp)
+	{
+		typedef typename __set_category<typename iterator_traits<InputIter1>::iterator_category,
+										typename iterator_traits<InputIter2>::iterator_category>::type category;
+		return jan::__set_intersection(first1, last1, first2, last2, res, comp, category());
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
+									   InputIter2 first2, InputIter2 last2,
+									   OutputIter res)
+	{
+		return jan::set_intersection(first1, last1, first2, last2, res,
+									 jan::less<typename iterator_traits<InputIter1>::value_type>());
+	}
+
+	/**
+	 * @brief 作为set_intersection的第一个参数, 表示两个区间都严格递增(没有重复元素)
+	 *        此时4或8字节整数的连续区间可以用SIMD块比较求交集
+	 */
+	struct sorted_unique_t { };
+	const sorted_unique_t sorted_unique{};
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter __set_intersection_unique(InputIter1 first1, InputIter1 last1,
+												InputIter2 first2, InputIter2 last2,
+												OutputIter res, _false_type)
+	{
+		return jan::set_intersection(first1, last1, first2, last2, res);
+	}
+
+#ifdef __JAN_SIMD_X86
+	template<typename Ptr, typename T>
+	inline T* __set_intersection_unique(Ptr first1, Ptr last1, Ptr first2, Ptr last2, T* res, _true_type)
+	{
+		//长度相差很大时倍增查找更快
+		if (jan::__gallop_side(last1 - first1, last2 - first2) != 0)
+			return jan::set_intersection(first1, last1, first2, last2, res);
+		return jan::__simd_intersect_unique<T>(first1, last1, first2, last2, res, __size_tag<sizeof(T)>());
+	}
+#endif
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	inline OutputIter set_intersection(sorted_unique_t, InputIter1 first1, InputIter1 last1,
+									   InputIter2 first2, InputIter2 last2,
+									   OutputIter res, Compare comp)
+	{
+		return jan::set_intersection(first1, last1, first2, last2, res, comp);
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter set_intersection(sorted_unique_t, InputIter1 first1, InputIter1 last1,
+									   InputIter2 first2, InputIter2 last2,
+									   OutputIter res)
+	{
+		typedef typename __simd_set_traits<InputIter1, InputIter2, OutputIter>::vectorizable vectorizable;
+		return jan::__set_intersection_unique(first1, last1, first2, last2, res, vectorizable());
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	OutputIter __set_symmetric_difference(InputIter1 first1, InputIter1 last1,
+										  InputIter2 first2, InputIter2 last2,
+										  OutputIter res, Compare comp, input_iterator_tag)
+	{
+		while (first1 != last1 && first2 != last2)
+		{
+			if(comp(*first1, *first2))
+			{
+				*res = *first1;
+				++res;
+				++first1;
+			}
+			else if(comp(*first2, *first1))
+			{
+				*res = *first2;
+				++first2;
+				++res;
+			}
+			else
+			{
+				++first1;
+				++first2;
+			}
+		}
+		return jan::copy(first2,last2,jan::copy(first1,last1,res));
+	}
+
+	template<typename RandomIter1, typename RandomIter2, typename OutputIter, typename Compare>
+	OutputIter __set_symmetric_difference(RandomIter1 first1, RandomIter1 last1,
+										  RandomIter2 first2, RandomIter2 last2,
+										  OutputIter res, Compare comp, random_access_iterator_tag)
+	{
+		switch (jan::__gallop_side(last1 - first1, last2 - first2))
+		{
+		case 1:
+			for (; first1 != last1; ++first1)
+			{
+				RandomIter2 pos = jan::__gallop_lower_bound(first2, last2, *first1, comp);
+				res = jan::copy(first2, pos, res);
+				first2 = pos;
+				if (first2 != last2 && !comp(*first1, *first2))
+					++first2;
+				else
+				{
+					*res = *first1;
+					++res;
+				}
+			}
+			return jan::copy(first2, last2, res);
+		case 2:
+			for (; first2 != last2; ++first2)
+			{
+				RandomIter1 pos = jan::__gallop_lower_bound(first1, last1, *first2, comp);
+				res = jan::copy(first1, pos, res);
+				first1 = pos;
+				if (first1 != last1 && !comp(*first2, *first1))
+					++first1;
+				else
+				{
+					*res = *first2;
+					++res;
+				}
+			}
+			return jan::copy(first1, last1, res);
+		default:
+			return jan::__set_symmetric_difference(first1, last1, first2, last2, res, comp, input_iterator_tag());
+		}
+	}
+
+	/**
+	 * @brief 集合的对称差算法
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam OutputIter 
+	 * @tparam Compare 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @param res 
+	 * @param comp 
+	 * @return OutputIter 
+	 */
+	template<typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	inline OutputIter set_symmetric_difference(InputIter1 first1, InputIter1 last1,
+											   InputIter2 first2, InputIter2 last2,
+											   OutputIter res, Compare comp)
+	{
+		typedef typename __set_category<typename iterator_traits<InputIter1>::iterator_category,
+										typename iterator_traits<InputIter2>::iterator_category>::type category;
+		return jan::__set_symmetric_difference(first1, last1, first2, last2, res, comp, category());
+	}
+
+	template<typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter set_symmetric_difference(InputIter1 first1, InputIter1 last1,
+											   InputIter2 first2, InputIter2 last2,
+											   OutputIter res)
+	{
+		return jan::set_symmetric_difference(first1, last1, first2, last2, res,
+											 jan::less<typename iterator_traits<InputIter1>::value_type>());
+	}
+
+	/**
+	 * @brief 合并两个有序区间到res, 相等时先取第一个区间的元素(稳定)
+	 * 
+	 * @tparam InputIter1 
+	 * @tparam InputIter2 
+	 * @tparam OutputIter 
+	 * @tparam Compare 
+	 * @param first1 
+	 * @param last1 
+	 * @param first2 
+	 * @param last2 
+	 * @param res 
+	 * @param comp 
+	 * @return OutputIter 
+	 */
+	template <typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	OutputIter merge(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+					 OutputIter res, Compare comp)
+	{
+		while (first1 != last1 && first2 != last2)
+		{
+			if(comp(*first2, *first1))
+				*res = *first2++;
+			else
+				*res = *first1++;
+			++res;
+		}
+		return jan::copy(first2, last2, jan::copy(first1, last1, res));
+	}
+
+	template <typename InputIter1, typename InputIter2, typename OutputIter>
+	inline OutputIter merge(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+							OutputIter res)
+	{
+		using T = typename iterator_traits<InputIter1>::value_type;
+		return jan::merge(first1, last1, first2, last2, res, jan::less<T>());
+	}
+
+	/************stable_sort***********/
+
+	template <typename InputIter, typename OutputIter>
+	inline OutputIter __move(InputIter first, InputIter last, OutputIter res)
+	{
+		for(; first != last; ++first, ++res)
+			*res = std::move(*first);
+		return res;
+	}
+
+	//与merge相同, 但是移动元素
+	template <typename InputIter1, typename InputIter2, typename OutputIter, typename Compare>
+	OutputIter __move_merge(InputIter1 first1, InputIter1 last1, InputIter2 first2, InputIter2 last2,
+							OutputIter res, Compare comp)
+	{
+		while (first1 != last1 && first2 != last2)
+		{
+			if(comp(*first2, *first1))
+				*res = std::move(*first2++);
+			else
+				*res = std::move(*first1++);
+			++res;
+		}
+		return jan::__move(first2, last2, jan::__move(first1, last1, res));
+	}
+
+	/**
+	 * @brief stable_sort使用的临时缓冲区, 通过jan::alloc申请, 申请失败就减半重试,
+	 *        最终可能比请求的小甚至为空, 此时stable_sort退化为原地归并
+	 *        缓冲区中的元素由*seed依次移动构造而来(最后再移回*seed), 所以不要求T有默认构造函数
+	 * 
+	 * @tparam T 
+	 */
+	template <typename T>
+	class _temporary_buffer
+	{
+	public:
+		template <typename ForwardIter>
+		_temporary_buffer(ForwardIter seed, size_t len) : _buf(nullptr), _len(len)
+		{
+			while (_len > 0)
+			{
+				try
+				{
+					_buf = data_allocator::allocate(_len);
+					break;
+				}
+				catch(const std::bad_alloc &)
+				{
+					_len /= 2;
+				}
+			}
+			if(_len == 0)
+				return;
+			T *cur = _buf;
+			try
+			{
+				jan::construct(cur, std::move(*seed));
+				for(++cur; cur != _buf + _len; ++cur)
+					jan::construct(cur, std::move(*(cur - 1)));
+				*seed = std::move(*(cur - 1));
+			}
+			catch(...)
+			{
+				if(cur != _buf)
+					*seed = std::move(*(cur - 1));
+				jan::destroy(_buf, cur);
+				data_allocator::deallocate(_buf, _len);
+				throw;
+			}
+		}
+		_temporary_buffer(const _temporary_buffer &) = delete;
+		_temporary_buffer &operator=(const _temporary_buffer &) = delete;
+		~_temporary_buffer()
+		{
+			if(_buf == nullptr)
+				return;
+			jan::destroy(_buf, _buf + _len);
+			data_allocator::deallocate(_buf, _len);
+		}
+		T *begin() const { return _buf; }
+		size_t size() const { return _len; }
+
+	private:
+		using data_allocator = alloc_adapter<T, jan::alloc>;
+		T *_buf;
+		size_t _len;
+	};
+
+	//自然有序段短于minrun时用插入排序补齐到minrun
+	template <typename Distance>
+	inline Distance __min_run(Distance n)
+	{
+		Distance r = 0;
+		while (n >= 64)
+		{
+			r |= n & 1;
+			n >>= 1;
+		}
+		return n + r;
+	}
+
+	/**
+	 * @brief 有序段起点表, 除最后一段外每段至少有minrun个元素, 所以容量可以预先算出
+	 * 
+	 * @tparam Distance 
+	 */
+	template <typename Distance>
+	class _run_list
+	{
+	public:
+		explicit _run_list(Distance n)
+			: _cap(n / jan::__min_run(n) + 2), _size(0)
+		{
+			_runs = data_allocator::allocate(_cap);
+		}
+		_run_list(const _run_list &) = delete;
+		_run_list &operator=(const _run_list &) = delete;
+		~_run_list() { data_allocator::deallocate(_runs, _cap); }
+		void push_back(Distance d) { _runs[_size++] = d; }
+		Distance & operator[](size_t i) { return _runs[i]; }
+		size_t size() const { return _size; }
+		void resize(size_t n) { _size = n; }
+
+	private:
+		using data_allocator = alloc_adapter<Distance, jan::alloc>;
+		size_t _cap;
+		size_t _size;
+		Distance *_runs;
+	};
+
+	/**
+	 * @brief 把[first,last)切分为有序段, 各段起点依次写入runs, 最后写入last - first
+	 *        严格递减的段就地翻转(严格递减翻转后仍然稳定), 短于minrun的段用插入排序补齐
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Distance 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param runs 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Distance, typename Compare>
+	void __find_runs(RandomIter first, RandomIter last, _run_list<Distance> & runs, Compare comp)
+	{
+		const Distance n = last - first;
+		const Distance min_run = jan::__min_run(n);
+		Distance start = 0;
+		while (start < n)
+		{
+			Distance end = start + 1;
+			if(end < n)
+			{
+				if(comp(*(first + end), *(first + end - 1)))
+				{
+					while (end < n && comp(*(first + end), *(first + end - 1)))
+						++end;
+					jan::reverse(first + start, first + end);
+				}
+				else
+					while (end < n && !comp(*(first + end), *(first + end - 1)))
+						++end;
+			}
+			if(end - start < min_run)
+			{
+				Distance force = n - start < min_run ? n : start + min_run;
+				jan::__insertion_sort(first + start, first + force, comp);
+				end = force;
+			}
+			runs.push_back(start);
+			start = end;
+		}
+		runs.push_back(n);
+	}
+
+	/**
+	 * @brief 一趟归并: 把src中相邻的两段合并到dst的相同位置, 落单的最后一段直接移过去
+	 *        两段本来就首尾有序时不做比较, 整体移动
+	 * 
+	 * @tparam Iter1 
+	 * @tparam Iter2 
+	 * @tparam Distance 
+	 * @tparam Compare 
+	 * @param src 
+	 * @param dst 
+	 * @param runs 
+	 * @param comp 
+	 */
+	template <typename Iter1, typename Iter2, typename Distance, typename Compare>
+	void __merge_pass(Iter1 src, Iter2 dst, _run_list<Distance> & runs, Compare comp)
+	{
+		const size_t count = runs.size() - 1;
+		size_t kept = 0;
+		for(size_t j = 0; j < count; j += 2, ++kept)
+		{
+			const Distance a = runs[j], b = runs[j + 1];
+			const Distance c = j + 2 <= count ? runs[j + 2] : b;
+			if(c == b || !comp(*(src + b), *(src + b - 1)))
+				jan::__move(src + a, src + c, dst + a);
+			else
+				jan::__move_merge(src + a, src + b, src + b, src + c, dst + a, comp);
+			runs[kept] = a;
+		}
+		runs[kept] = runs[count];
+		runs.resize(kept + 1);
+	}
+
+	/**
+	 * @brief 缓冲区不小于区间长度时, 在原区间与缓冲区之间来回归并, 每趟段数减半
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Pointer 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param buf 
+	 * @param comp 
 	 */
-	template<typename InputIter1, typename InputIter2, typename OutputIter>
-	OutputIter set_diffrence(InputIter1 first1, InputIter1 last1,
-								InputIter2 first2, InputIter2 last2,
-								OutputIter res)
+	template <typename RandomIter, typename Pointer, typename Compare>
+	void __stable_sort_ping_pong(RandomIter first, RandomIter last, Pointer buf, Compare comp)
 	{
-		while (first1 != last1 && first2 != last2)
+		using Distance = typename iterator_traits<RandomIter>::difference_type;
+		_run_list<Distance> runs(last - first);
+		jan::__find_runs(first, last, runs, comp);
+		bool in_buf = false;
+		while (runs.size() > 2)
 		{
-			if (*first1 > *first2)
-				++first2;
-			else if (*first1 < *first2)
-			{
-				*res = *first1;
-				++res;
-				++first1;
-			}
+			if(in_buf)
+				jan::__merge_pass(buf, first, runs, comp);
 			else
-			{
-				++first1;
-				++first2;
-			}
+				jan::__merge_pass(first, buf, runs, comp);
+			in_buf = !in_buf;
 		}
-		return jan::copy(first1, last1, res);
+		if(in_buf)
+			jan::__move(buf, buf + (last - first), first);
 	}
 
-	template<typename InputIter1, typename InputIter2, typename OutputIter>
-	OutputIter set_intersection(InputIter1 first1, InputIter1 last1,
-								InputIter2 first2, InputIter2 last2,
-								OutputIter res)
+	/**
+	 * @brief 合并相邻的有序段[first,middle)和[middle,last), 不使用额外空间
+	 *        在较长的一段取中点, 用二分查找在另一段找到分割点, 旋转后分别递归
+	 * 
+	 * @tparam BidirectionalIter 
+	 * @tparam Distance 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param middle 
+	 * @param last 
+	 * @param len1 
+	 * @param len2 
+	 * @param comp 
+	 */
+	template <typename BidirectionalIter, typename Distance, typename Compare>
+	void __merge_without_buffer(BidirectionalIter first, BidirectionalIter middle, BidirectionalIter last,
+								Distance len1, Distance len2, Compare comp)
 	{
-		while (first1 != last1 && first2 != last2)
+		if(len1 == 0 || len2 == 0)
+			return;
+		if(len1 + len2 == 2)
 		{
-			if (*first1 < *first2)
-				++first1;
-			else if (*first2 < *first1)
-				++first2;
-			else
-			{
-				*res = *first1;
-				++first1;
-				++first2;
-				++res;
-			}
+			if(comp(*middle, *first))
+				jan::iter_swap(first, middle);
+			return;
 		}
-		return res;
+		BidirectionalIter first_cut = first;
+		BidirectionalIter second_cut = middle;
+		Distance len11, len22;
+		if(len1 > len2)
+		{
+			len11 = len1 / 2;
+			jan::advance(first_cut, len11);
+			second_cut = jan::lower_bound(middle, last, *first_cut, comp);
+			len22 = jan::distance(middle, second_cut);
+		}
+		else
+		{
+			len22 = len2 / 2;
+			jan::advance(second_cut, len22);
+			first_cut = jan::upper_bound(first, middle, *second_cut, comp);
+			len11 = jan::distance(first, first_cut);
+		}
+		BidirectionalIter new_middle = jan::rotate(first_cut, middle, second_cut);
+		jan::__merge_without_buffer(first, first_cut, new_middle, len11, len22, comp);
+		jan::__merge_without_buffer(new_middle, second_cut, last, len1 - len11, len2 - len22, comp);
 	}
 
 	/**
-	 * @brief 集合的对称差算法
+	 * @brief 合并相邻的有序段, 较短的一段能放进缓冲区时移进去再合并回原处,
+	 *        否则像__merge_without_buffer一样分割后递归
 	 * 
-	 * @tparam InputIter1 
-	 * @tparam InputIter2 
-	 * @tparam OutputIter 
-	 * @param first1 
-	 * @param last1 
-	 * @param first2 
-	 * @param last2 
-	 * @param res 
-	 * @return OutputIter 
+	 * @tparam RandomIter 
+	 * @tparam Pointer 
+	 * @tparam Distance 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param middle 
+	 * @param last 
+	 * @param len1 
+	 * @param len2 
+	 * @param buf 
+	 * @param buf_len 
+	 * @param comp 
 	 */
-	template<typename InputIter1, typename InputIter2, typename OutputIter>
-	OutputIter set_symmetric_difference(InputIter1 first1, InputIter1 last1,
-								InputIter2 first2, InputIter2 last2,
-								OutputIter res)
+	template <typename RandomIter, typename Pointer, typename Distance, typename Compare>
+	void __merge_adaptive(RandomIter first, RandomIter middle, RandomIter last,
+						  Distance len1, Distance len2, Pointer buf, Distance buf_len, Compare comp)
 	{
-		while (first1 != last1 && first2 != last2)
+		if(len1 == 0 || len2 == 0 || !comp(*middle, *(middle - 1)))
+			return;
+		if(len1 <= len2 && len1 <= buf_len)
 		{
-			if(*first1 < *first2)
-			{
-				*res = *first1;
-				++res;
-				++first1;
-			}
-			else if(*first2 < *first1)
+			Pointer buf_end = jan::__move(first, middle, buf);
+			jan::__move_merge(buf, buf_end, middle, last, first, comp);
+			return;
+		}
+		if(len2 <= buf_len)
+		{
+			//从后往前合并, 相等时先放第二段的元素
+			Pointer buf_end = jan::__move(middle, last, buf);
+			RandomIter res = last;
+			while (buf != buf_end && first != middle)
 			{
-				*res = *first2;
-				++first2;
-				++res;
+				if(comp(*(buf_end - 1), *(middle - 1)))
+					*--res = std::move(*--middle);
+				else
+					*--res = std::move(*--buf_end);
 			}
-			else
+			while (buf != buf_end)
+				*--res = std::move(*--buf_end);
+			return;
+		}
+		if(buf_len == 0)
+		{
+			jan::__merge_without_buffer(first, middle, last, len1, len2, comp);
+			return;
+		}
+		RandomIter first_cut, second_cut;
+		Distance len11, len22;
+		if(len1 > len2)
+		{
+			len11 = len1 / 2;
+			first_cut = first + len11;
+			second_cut = jan::lower_bound(middle, last, *first_cut, comp);
+			len22 = second_cut - middle;
+		}
+		else
+		{
+			len22 = len2 / 2;
+			second_cut = middle + len22;
+			first_cut = jan::upper_bound(first, middle, *second_cut, comp);
+			len11 = first_cut - first;
+		}
+		RandomIter new_middle = jan::rotate(first_cut, middle, second_cut);
+		jan::__merge_adaptive(first, first_cut, new_middle, len11, len22, buf, buf_len, comp);
+		jan::__merge_adaptive(new_middle, second_cut, last, len1 - len11, len2 - len22, buf, buf_len, comp);
+	}
+
+	/**
+	 * @brief 稳定排序, 缓冲区[buf, buf + buf_len)中的元素必须已经构造好, 排序后其内容未指定,
+	 *        调用者可以在多次排序之间重复使用同一个缓冲区
+	 *        缓冲区不小于区间长度时来回归并; 否则原地合并相邻的有序段, 能用缓冲区时就用
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @tparam Pointer 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 * @param buf 
+	 * @param buf_len 
+	 */
+	template <typename RandomIter, typename Compare, typename Pointer>
+	void stable_sort(RandomIter first, RandomIter last, Compare comp, Pointer buf, size_t buf_len)
+	{
+		using Distance = typename iterator_traits<RandomIter>::difference_type;
+		const Distance n = last - first;
+		if(n < 2)
+			return;
+		if(buf_len >= static_cast<size_t>(n))
+		{
+			jan::__stable_sort_ping_pong(first, last, buf, comp);
+			return;
+		}
+		_run_list<Distance> runs(last - first);
+		jan::__find_runs(first, last, runs, comp);
+		while (runs.size() > 2)
+		{
+			size_t kept = 0;
+			for(size_t j = 0; j + 1 < runs.size(); j += 2, ++kept)
 			{
-				++first1;
-				++first2;
+				if(j + 2 < runs.size())
+					jan::__merge_adaptive(first + runs[j], first + runs[j + 1], first + runs[j + 2],
+										  runs[j + 1] - runs[j], runs[j + 2] - runs[j + 1],
+										  buf, static_cast<Distance>(buf_len), comp);
+				runs[kept] = runs[j];
 			}
+			runs[kept] = n;
+			runs.resize(kept + 1);
 		}
-		return jan::copy(first2,last2,jan::copy(first1,last1,res));
 	}
 
-	template <typename InputIter, typename T>
-	typename iterator_traits<InputIter>::difference_type
-	count(InputIter first, InputIter last, const T & val)
+	/**
+	 * @brief 稳定排序, 通过jan::alloc申请一个与区间等长的缓冲区, 申请不到时退化为原地归并
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam Compare 
+	 * @param first 
+	 * @param last 
+	 * @param comp 
+	 */
+	template <typename RandomIter, typename Compare>
+	void stable_sort(RandomIter first, RandomIter last, Compare comp)
 	{
-		typename iterator_traits<InputIter>::difference_type ret;
-		for(; first !=last; ++first)
-			if(*first == val)
-				++ret;
-		return ret;
+		if(last - first < 2)
+			return;
+		using T = typename iterator_traits<RandomIter>::value_type;
+		_temporary_buffer<T> buf(first, last - first);
+		jan::stable_sort(first, last, comp, buf.begin(), buf.size());
 	}
 
-	template <typename InputIter, typename Predicate>
-	typename iterator_traits<InputIter>::difference_type
-	count_if(InputIter first, InputIter last, Predicate pred)
+	template <typename RandomIter>
+	inline void stable_sort(RandomIter first, RandomIter last)
 	{
-		typename iterator_traits<InputIter>::difference_type ret;
-		for(; first != last; ++first)
-			if(pred(*first))
-				++ret;
-		return ret;
+		using T = typename iterator_traits<RandomIter>::value_type;
+		jan::stable_sort(first, last, jan::less<T>());
 	}
 
-	template <typename ForwardIter>
-	ForwardIter adjacent_find(ForwardIter first, ForwardIter last)
+ /**
+  * @brief 归并排序, 保留原来的接口, 转发给stable_sort
+  * 
+  * @tparam RandomIter 
+  * @param first 
+  * @param last 
+  */
+	template <typename RandomIter>
+	inline void merge_sort(RandomIter first, RandomIter last)
 	{
-		ForwardIter next = first;
-		++next;
-		while (next != last)
-		{
-			if(*next == *first)
-				return first;
-			++first;
-			++next;
-		}
-		return last;
+		jan::stable_sort(first, last);
 	}
 
-	template <typename ForwardIter, typename BinaryPredicate>
-	ForwardIter adjacent_find(ForwardIter first, ForwardIter last, BinaryPredicate bin_pred)
+	/************radix_sort***********/
+
+	//与K等宽的无符号整数
+	template <size_t Size> struct __unsigned_of_size;
+	template <> struct __unsigned_of_size<1> { typedef unsigned char type; };
+	template <> struct __unsigned_of_size<2> { typedef unsigned short type; };
+	template <> struct __unsigned_of_size<4> { typedef unsigned int type; };
+	template <> struct __unsigned_of_size<8> { typedef unsigned long long type; };
+
+	/**
+	 * @brief 把整数key编码为无符号整数, 使无符号比较的结果与原类型的比较结果一致
+	 *        有符号数翻转符号位即可
+	 * 
+	 * @tparam K 
+	 */
+	template <typename K, bool = std::is_floating_point<K>::value>
+	struct __radix_key
 	{
-		ForwardIter next = first;
-		++next;
-		while (next != last)
+		typedef typename __unsigned_of_size<sizeof(K)>::type type;
+		static type encode(K k)
 		{
-			if(bin_pred(*first,*next))
-				return first;
-			++first;
-			++next;
+			const type sign = std::is_signed<K>::value ? type(type(1) << (sizeof(K) * 8 - 1)) : type(0);
+			return static_cast<type>(static_cast<type>(k) ^ sign);
 		}
-		return last;
-	}
-	
-	template <typename InputIter, typename T>
-	InputIter find(InputIter first, InputIter last, const T & val)
+	};
+
+	/**
+	 * @brief 浮点数key: 正数置符号位, 负数按位取反, 得到的无符号数与浮点数顺序一致
+	 *        (-0.0排在0.0之前, NaN按符号排在两端)
+	 * 
+	 * @tparam K 
+	 */
+	template <typename K>
+	struct __radix_key<K, true>
 	{
-		while (first != last)
+		static_assert(sizeof(K) == 4 || sizeof(K) == 8, "radix_sort supports float and double keys only");
+		typedef typename __unsigned_of_size<sizeof(K)>::type type;
+		static type encode(K k)
 		{
-			if(*first == val)
-				return first;
-			++first;
+			type u;
+			memcpy(&u, &k, sizeof(K));
+			const type sign = type(1) << (sizeof(K) * 8 - 1);
+			return (u & sign) ? type(~u) : type(u | sign);
 		}
-		return last;
-	}
+	};
 
-	template <typename InputIter, typename T, typename Predicate>
-	InputIter find_if(InputIter first, InputIter last, const T & val, Predicate pred)
+	//默认的key: 元素本身
+	struct __radix_identity
 	{
-		while (first != last)
+		template <typename T>
+		const T & operator()(const T & val) const { return val; }
+	};
+
+	/**
+	 * @brief 按第shift位开始的8位把src中的n个元素分配到dst, offset是各个桶的起始位置
+	 * 
+	 * @tparam Iter1 
+	 * @tparam Iter2 
+	 * @tparam KeyFn 
+	 * @param src 
+	 * @param dst 
+	 * @param n 
+	 * @param shift 
+	 * @param offset 
+	 * @param key 
+	 */
+	template <typename Iter1, typename Iter2, typename KeyFn>
+	void __radix_scatter(Iter1 src, Iter2 dst, size_t n, unsigned shift, size_t * offset, KeyFn key)
+	{
+		using K = typename std::decay<decltype(key(*src))>::type;
+		for(size_t i = 0; i < n; ++i, ++src)
 		{
-			if(pred(*first))
-				return first;
-			++first;
+			const size_t digit = (__radix_key<K>::encode(key(*src)) >> shift) & 0xFF;
+			*(dst + offset[digit]++) = std::move(*src);
 		}
-		return last;
 	}
 
-	template <typename InputIter, typename F>
-	F for_each(InputIter first, InputIter last, F f)
+	/**
+	 * @brief LSD基数排序, 稳定, 按key_fn(元素)的值升序排列
+	 *        key可以是整数、float或double; 每趟处理8位, 一次遍历统计出所有趟的直方图,
+	 *        某一趟所有元素的这8位都相同时跳过这一趟
+	 *        在原区间与一个通过jan::alloc申请的等长缓冲区之间来回分配,
+	 *        申请不到足够的缓冲区时改用stable_sort, 并把已经拿到的那部分缓冲区交给它, 不再申请第二次
+	 * 
+	 * @tparam RandomIter 
+	 * @tparam KeyFn 
+	 * @param first 
+	 * @param last 
+	 * @param key 
+	 */
+	template <typename RandomIter, typename KeyFn>
+	void radix_sort(RandomIter first, RandomIter last, KeyFn key)
 	{
-		while (first != last)
+		using T = typename iterator_traits<RandomIter>::value_type;
+		using K = typename std::decay<decltype(key(*first))>::type;
+		using U = typename __radix_key<K>::type;
+		enum { PASSES = sizeof(U) };
+		const size_t n = last - first;
+		if(n < 2)
+			return;
+
+		size_t count[PASSES][256] = {};
+		for(RandomIter it = first; it != last; ++it)
 		{
-			f(*first);
-			++first;
+			U u = __radix_key<K>::encode(key(*it));
+			for(int p = 0; p < PASSES; ++p)
+				++count[p][(u >> (8 * p)) & 0xFF];
 		}
-		return f;
+
+		_temporary_buffer<T> buf(first, n);
+		if(buf.size() < n)
+		{
+			jan::stable_sort(first, last, [&key](const T & a, const T & b) {
+				return __radix_key<K>::encode(key(a)) < __radix_key<K>::encode(key(b));
+			}, buf.begin(), buf.size());
+			return;
+		}
+		bool in_buf = false;
+		for(int p = 0; p < PASSES; ++p)
+		{
+			size_t offset[256];
+			size_t sum = 0;
+			bool uniform = false;
+			for(int d = 0; d < 256; ++d)
+			{
+				if(count[p][d] == n)
+					uniform = true;
+				offset[d] = sum;
+				sum += count[p][d];
+			}
+			if(uniform)
+				continue;
+			if(in_buf)
+				jan::__radix_scatter(buf.begin(), first, n, 8 * p, offset, key);
+			else
+				jan::__radix_scatter(first, buf.begin(), n, 8 * p, offset, key);
+			in_buf = !in_buf;
+		}
+		if(in_buf)
+			jan::__move(buf.begin(), buf.begin() + n, first);
 	}
 
- /**
-  * @brief 在写这个排序算法的时候，还没有自建的vector容器，所以使用std::vector
-  * 
-  * @tparam RandomIter 
-  * @param first 
-  * @param last 
-  */
 	template <typename RandomIter>
-	void merge_sort(RandomIter first, RandomIter last)
+	inline void radix_sort(RandomIter first, RandomIter last)
 	{
-		if(first == last - 1)
-			return;
-		using distance_type = typename iterator_traits<RandomIter>::difference_type;
-		distance_type dis = (last - first) / 2;
-		auto mid = first + dis;
-		merge_sort_iter(first,mid);
-		merge_sort_iter(mid, last);
-		using value_type = typename iterator_traits<RandomIter>::value_type;
-		std::vector<value_type> vec(last-first);
-		merge(first,mid,mid,last,vec.begin());
-		copy(vec.begin(),vec.end(),first);
-	}	
+		jan::radix_sort(first, last, __radix_identity());
+	}
+
+	//元素个数不超过此值时auto_sort不使用基数排序
+	enum { __RADIX_SORT_THRESHOLD = 1024 };
+
+	template <typename RandomIter>
+	inline void __auto_sort(RandomIter first, RandomIter last, _true_type)
+	{
+		if(last - first > __RADIX_SORT_THRESHOLD)
+			jan::radix_sort(first, last);
+		else
+			jan::sort(first, last);
+	}
+
+	template <typename RandomIter>
+	inline void __auto_sort(RandomIter first, RandomIter last, _false_type)
+	{
+		jan::sort(first, last);
+	}
+
+	/**
+	 * @brief 升序排序, 由is_integer选择算法: 元素为整数且个数较多时用radix_sort, 否则用sort
+	 * 
+	 * @tparam RandomIter 
+	 * @param first 
+	 * @param last 
+	 */
+	template <typename RandomIter>
+	inline void auto_sort(RandomIter first, RandomIter last)
+	{
+		using T = typename iterator_traits<RandomIter>::value_type;
+		using integral = typename is_integer<T>::integral;
+		jan::__auto_sort(first, last, integral());
+	}
 
   /**
    * @brief 填充从first开始n个元素为val
@@ -646,7 +2659,7 @@ namespace jan
    * @return OutputIter 
    */
   template <typename OutputIter, typename Size , typename T>
-  inline OutputIter fill_n(OutputIter first, Size n, const T & val)
+  inline OutputIter __fill_n(OutputIter first, Size n, const T & val, _false_type)
   {
     while(n--)
     {
@@ -656,6 +2669,86 @@ namespace jan
     return first;
   }
 
+  /**
+   * @brief 能按字节模式填充的迭代器: 指向POD类型的指针, 并且元素大小整除16,
+   *        这样64字节的模式在任何元素边界上都相同
+   * 
+   * @tparam Iter 
+   */
+  template <typename Iter>
+  struct __fill_traits
+  {
+    typedef _false_type pattern;
+  };
+
+#ifdef __JAN_SIMD_X86
+  template <typename T, bool = (16 % sizeof(T) == 0)>
+  struct __fill_pattern_type
+  {
+    typedef _false_type pattern;
+  };
+
+  template <typename T>
+  struct __fill_pattern_type<T, true>
+  {
+    typedef typename type_traits<T>::is_POD_type pattern;
+  };
+
+  template <typename T>
+  struct __fill_traits<T*> : __fill_pattern_type<T>
+  {
+  };
+
+  enum { __FILL_PATTERN_MIN = 256 };
+
+  /**
+   * @brief 向量化的填充: 把val重复成64字节的模式, 先逐个填充到64字节对齐,
+   *        中间整块写入, 不少于streaming_threshold()字节时使用non-temporal写
+   *        所有字节都相同并且不需要non-temporal写时直接用memset
+   * 
+   * @tparam T 
+   * @tparam Size 
+   * @tparam V 
+   * @param first 
+   * @param n 
+   * @param val 
+   * @return T* 
+   */
+  template <typename T, typename Size, typename V>
+  T* __fill_n(T* first, Size n, const V & val, _true_type)
+  {
+    if (n <= 0)
+      return first;
+    const T tmp = val;
+    const size_t count = static_cast<size_t>(n);
+    if (count * sizeof(T) < __FILL_PATTERN_MIN)
+      return jan::__fill_n(first, count, tmp, _false_type());
+    char pattern[64];
+    for (size_t i = 0; i < sizeof(pattern); i += sizeof(T))
+      memcpy(pattern + i, &tmp, sizeof(T));
+    bool stream = count * sizeof(T) >= __STREAM_MIN && count * sizeof(T) >= streaming_threshold();
+    if (!stream && memcmp(pattern, pattern + 1, sizeof(pattern) - 1) == 0)
+    {
+      memset(first, pattern[0], count * sizeof(T));
+      return first + count;
+    }
+    T* last = first + count;
+    while (first != last && reinterpret_cast<uintptr_t>(first) % 64 != 0)
+      *first++ = tmp;
+    //元素的对齐小于它的大小时可能永远对不齐64字节, 此时不能用non-temporal写
+    if (reinterpret_cast<uintptr_t>(first) % 64 != 0)
+      stream = false;
+    jan::__simd_fill(first, (last - first) * sizeof(T), pattern, stream);
+    return last;
+  }
+#endif
+
+  template <typename OutputIter, typename Size , typename T>
+  inline OutputIter fill_n(OutputIter first, Size n, const T & val)
+  {
+    return jan::__fill_n(first, n, val, typename __fill_traits<OutputIter>::pattern());
+  }
+
   /**
    * @brief 填充[first,last)区间的元素为val
    * 
@@ -667,13 +2760,27 @@ namespace jan
    * @return ForwardIter 
    */
   template <typename ForwardIter, typename T>
-  inline ForwardIter fill(ForwardIter first, ForwardIter last, const T & val)
+  inline ForwardIter __fill(ForwardIter first, ForwardIter last, const T & val, _false_type)
   {
     for(;first != last; ++first)
       *first = val;
     return first;
   }
 
+#ifdef __JAN_SIMD_X86
+  template <typename T, typename V>
+  inline T* __fill(T* first, T* last, const V & val, _true_type)
+  {
+    return jan::__fill_n(first, last - first, val, _true_type());
+  }
+#endif
+
+  template <typename ForwardIter, typename T>
+  inline ForwardIter fill(ForwardIter first, ForwardIter last, const T & val)
+  {
+    return jan::__fill(first, last, val, typename __fill_traits<ForwardIter>::pattern());
+  }
+
 }// namespace jan
 
 #endif
@@ -301,7 +301,7 @@ namespace jan{
 			start_free = (char *)malloc(byte_to_get);
 
 			//������������Ѱ�ҿ����ڴ�
-			if(res == nullptr)
+			if(start_free == nullptr)
 			{
 				size_t i;
 				obj **free_list_of_index;
@@ -417,14 +417,21 @@ namespace jan{
 			return (T*)Alloc::allocate(sizeof (T));
 		}
 
+    /**
+     * @brief 归还size个T大小的内存, size必须与allocate时相同，二级配置器靠它找到对应的空闲链表
+     * 
+     * @param p 
+     * @param size 
+     */
 		static void deallocate(T * p, size_t size)
 		{
-			Alloc::deallocate(p,size);
+			if(p != nullptr)
+				Alloc::deallocate(p,size * sizeof (T));
 		}
 
 		static void deallocate(T * p)
 		{
-			Alloc::dellocate(p,sizeof (T));
+			Alloc::deallocate(p,sizeof (T));
 		}
 	};
 }	//namespace jan
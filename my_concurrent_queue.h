@@ -0,0 +1,762 @@
+#ifndef __MY_CONCURRENT_QUEUE_H_
+#define __MY_CONCURRENT_QUEUE_H_
+
+#include "my_allocator.h"
+#include "my_functional.h"
+#include "my_heap.h"
+#include "my_vector.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace jan {
+
+//缓存行大小, 用于把生产者与消费者各自频繁写的变量隔开, 避免伪共享
+enum { _CACHE_LINE_SIZE = 64 }; // NOLINT(bugprone-reserved-identifier)
+
+/**
+ * @brief 将容量向上取整为2的幂, 这样环形缓冲区的下标可以用 & mask 代替取模
+ *
+ * @param n
+ * @return size_t
+ */
+inline size_t __ring_capacity(size_t n)
+{
+  if (n == 0)
+    throw std::invalid_argument("capacity is zero");
+  size_t cap = 1;
+  while (cap < n)
+    cap <<= 1;
+  return cap;
+}
+
+/**
+ * @brief 单生产者单消费者的有界队列, push和pop均为wait-free
+ *        存储方式与deque的缓冲区相同，是一整块连续的元素空间，只不过首尾相接成环,
+ *        _head与_tail只增不减，用 & _mask 映射到缓冲区中的位置
+ *        生产者只写_tail, 消费者只写_head, 二者各占一个缓存行,
+ *        并且各自缓存一份对方的位置, 只有在缓存的值显示队列满(空)时才重新读取原子变量
+ *        默认使用一级配置器，因为二级配置器的内存池不是线程安全的
+ *
+ * @tparam T
+ * @tparam Alloc
+ */
+template <typename T, typename Alloc = jan::malloc_alloc>
+class alignas(_CACHE_LINE_SIZE) spsc_queue
+{
+public:
+  using value_type = T;
+  using size_type = size_t;
+
+  explicit spsc_queue(size_type capacity)
+      : _mask(__ring_capacity(capacity) - 1), _head(0), _tail_cache(0),
+        _tail(0), _head_cache(0)
+  {
+    _buffer = data_allocator::allocate(_mask + 1);
+  }
+  spsc_queue(const spsc_queue &) = delete;
+  spsc_queue &operator=(const spsc_queue &) = delete;
+  ~spsc_queue();
+
+  size_type capacity() const { return _mask + 1; }
+  //只是一个近似值, 另一端的线程随时可能修改它
+  //先读_head再读_tail: 第三个线程先读到旧的_tail时, 消费者可能已经越过它, 无符号相减会回绕
+  size_type size_approx() const
+  {
+    size_type head = _head.load(std::memory_order_acquire);
+    size_type tail = _tail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+  bool empty() const { return size_approx() == 0; }
+
+  bool try_push(const T &val) { return try_emplace(val); }
+  bool try_push(T &&val) { return try_emplace(std::move(val)); }
+  template <typename... Args> bool try_emplace(Args &&...args);
+  bool try_pop(T &out);
+
+  template <typename InputIter>
+  size_type try_push_n(InputIter first, size_type n);
+  template <typename OutputIter>
+  size_type try_pop_n(OutputIter res, size_type n);
+
+private:
+  using data_allocator = alloc_adapter<T, Alloc>;
+  T *slot(size_type pos) const { return _buffer + (pos & _mask); }
+  size_type free_slots(size_type tail);
+  size_type ready_slots(size_type head);
+
+  T *_buffer;
+  size_type _mask;
+  //消费者一侧
+  alignas(_CACHE_LINE_SIZE) std::atomic<size_type> _head;
+  size_type _tail_cache;
+  //生产者一侧
+  alignas(_CACHE_LINE_SIZE) std::atomic<size_type> _tail;
+  size_type _head_cache;
+};
+
+/**
+ * @brief 生产者可用的空位数, 缓存的_head不够用时才去读真正的_head
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @param tail
+ * @return spsc_queue<T, Alloc>::size_type
+ */
+template <typename T, typename Alloc>
+typename spsc_queue<T, Alloc>::size_type
+spsc_queue<T, Alloc>::free_slots(size_type tail)
+{
+  size_type free = capacity() - (tail - _head_cache);
+  if (free == 0)
+  {
+    _head_cache = _head.load(std::memory_order_acquire);
+    free = capacity() - (tail - _head_cache);
+  }
+  return free;
+}
+
+/**
+ * @brief 消费者可读的元素个数, 缓存的_tail显示为空时才去读真正的_tail
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @param head
+ * @return spsc_queue<T, Alloc>::size_type
+ */
+template <typename T, typename Alloc>
+typename spsc_queue<T, Alloc>::size_type
+spsc_queue<T, Alloc>::ready_slots(size_type head)
+{
+  size_type ready = _tail_cache - head;
+  if (ready == 0)
+  {
+    _tail_cache = _tail.load(std::memory_order_acquire);
+    ready = _tail_cache - head;
+  }
+  return ready;
+}
+
+/**
+ * @brief 原地构造一个元素到队尾, 队列满时返回false, 只能由生产者线程调用
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @tparam Args
+ * @param args
+ * @return bool
+ */
+template <typename T, typename Alloc>
+template <typename... Args>
+bool spsc_queue<T, Alloc>::try_emplace(Args &&...args)
+{
+  const size_type tail = _tail.load(std::memory_order_relaxed);
+  if (free_slots(tail) == 0)
+    return false;
+  construct(slot(tail), std::forward<Args>(args)...);
+  _tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief 取出队首元素移动到out中, 队列空时返回false, 只能由消费者线程调用
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @param out
+ * @return bool
+ */
+template <typename T, typename Alloc>
+bool spsc_queue<T, Alloc>::try_pop(T &out)
+{
+  const size_type head = _head.load(std::memory_order_relaxed);
+  if (ready_slots(head) == 0)
+    return false;
+  T *p = slot(head);
+  out = std::move(*p);
+  destroy(p);
+  _head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief 从first开始最多放入n个元素, 返回实际放入的个数
+ *        整批元素只需要一次_tail的release写, 原子操作的开销被均摊
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @tparam InputIter
+ * @param first
+ * @param n
+ * @return spsc_queue<T, Alloc>::size_type
+ */
+template <typename T, typename Alloc>
+template <typename InputIter>
+typename spsc_queue<T, Alloc>::size_type
+spsc_queue<T, Alloc>::try_push_n(InputIter first, size_type n)
+{
+  const size_type tail = _tail.load(std::memory_order_relaxed);
+  size_type free = capacity() - (tail - _head_cache);
+  if (free < n)
+  {
+    _head_cache = _head.load(std::memory_order_acquire);
+    free = capacity() - (tail - _head_cache);
+  }
+  const size_type count = n < free ? n : free;
+  size_type i = 0;
+  try {
+    for (; i < count; ++i, ++first)
+      construct(slot(tail + i), *first);
+  } catch (...) {
+    //已经构造好的元素照常发布
+    _tail.store(tail + i, std::memory_order_release);
+    throw;
+  }
+  _tail.store(tail + count, std::memory_order_release);
+  return count;
+}
+
+/**
+ * @brief 最多取出n个元素写到res, 返回实际取出的个数
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @tparam OutputIter
+ * @param res
+ * @param n
+ * @return spsc_queue<T, Alloc>::size_type
+ */
+template <typename T, typename Alloc>
+template <typename OutputIter>
+typename spsc_queue<T, Alloc>::size_type
+spsc_queue<T, Alloc>::try_pop_n(OutputIter res, size_type n)
+{
+  const size_type head = _head.load(std::memory_order_relaxed);
+  size_type ready = _tail_cache - head;
+  if (ready < n)
+  {
+    _tail_cache = _tail.load(std::memory_order_acquire);
+    ready = _tail_cache - head;
+  }
+  const size_type count = n < ready ? n : ready;
+  for (size_type i = 0; i < count; ++i, ++res)
+  {
+    T *p = slot(head + i);
+    *res = std::move(*p);
+    destroy(p);
+  }
+  _head.store(head + count, std::memory_order_release);
+  return count;
+}
+
+/**
+ * @brief 析构剩余的元素并归还缓冲区, 调用时不能再有线程访问队列
+ *
+ * @tparam T
+ * @tparam Alloc
+ */
+template <typename T, typename Alloc>
+spsc_queue<T, Alloc>::~spsc_queue()
+{
+  const size_type tail = _tail.load(std::memory_order_relaxed);
+  for (size_type pos = _head.load(std::memory_order_relaxed); pos != tail; ++pos)
+    destroy(slot(pos));
+  data_allocator::deallocate(_buffer, capacity());
+}
+
+/**
+ * @brief 多生产者多消费者的有界队列, 基于Dmitry Vyukov的算法
+ *        每个槽位带一个序号: 序号 == pos 表示第pos次写入可以使用此槽位,
+ *        序号 == pos + 1 表示第pos次写入的元素已经可以读取
+ *        生产者和消费者分别只用一次CAS抢占位置, 没有锁, 也没有ABA问题
+ *        元素构造在抢到槽位之后进行, 所以要求T的移动构造不抛出异常,
+ *        以免槽位被抢占后永远无法发布
+ *
+ * @tparam T
+ * @tparam Alloc
+ */
+template <typename T, typename Alloc = jan::malloc_alloc>
+class alignas(_CACHE_LINE_SIZE) mpmc_queue
+{
+  static_assert(std::is_nothrow_move_constructible<T>::value,
+                "mpmc_queue requires a nothrow move constructor");
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+
+  explicit mpmc_queue(size_type capacity);
+  mpmc_queue(const mpmc_queue &) = delete;
+  mpmc_queue &operator=(const mpmc_queue &) = delete;
+  ~mpmc_queue();
+
+  size_type capacity() const { return _mask + 1; }
+  size_type size_approx() const
+  {
+    size_type tail = _enqueue_pos.load(std::memory_order_acquire);
+    size_type head = _dequeue_pos.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+  bool empty() const { return size_approx() == 0; }
+
+  //先在本地构造好元素再抢占槽位, 这样拷贝抛出异常时队列不受影响
+  bool try_push(const T &val) { return try_push(T(val)); }
+  bool try_push(T &&val);
+  template <typename... Args> bool try_emplace(Args &&...args)
+  {
+    return try_push(T(std::forward<Args>(args)...));
+  }
+  bool try_pop(T &out);
+
+  template <typename InputIter>
+  size_type try_push_n(InputIter first, size_type n);
+  template <typename OutputIter>
+  size_type try_pop_n(OutputIter res, size_type n);
+
+private:
+  struct cell
+  {
+    std::atomic<size_type> _seq;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+    T *data() { return reinterpret_cast<T *>(&_storage); }
+  };
+  using cell_allocator = alloc_adapter<cell, Alloc>;
+
+  template <typename InputIter>
+  size_type __try_push_n(InputIter first, size_type n, _true_type);
+  template <typename InputIter>
+  size_type __try_push_n(InputIter first, size_type n, _false_type);
+
+  cell *_buffer;
+  size_type _mask;
+  alignas(_CACHE_LINE_SIZE) std::atomic<size_type> _enqueue_pos;
+  alignas(_CACHE_LINE_SIZE) std::atomic<size_type> _dequeue_pos;
+};
+
+template <typename T, typename Alloc>
+mpmc_queue<T, Alloc>::mpmc_queue(size_type capacity)
+    : _mask(__ring_capacity(capacity) - 1), _enqueue_pos(0), _dequeue_pos(0)
+{
+  _buffer = cell_allocator::allocate(_mask + 1);
+  for (size_type i = 0; i <= _mask; ++i)
+    new (&_buffer[i]._seq) std::atomic<size_type>(i);
+}
+
+/**
+ * @brief 放入一个元素, 队列满时返回false
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @param val
+ * @return bool
+ */
+template <typename T, typename Alloc>
+bool mpmc_queue<T, Alloc>::try_push(T &&val)
+{
+  size_type pos = _enqueue_pos.load(std::memory_order_relaxed);
+  cell *c;
+  while (true)
+  {
+    c = &_buffer[pos & _mask];
+    size_type seq = c->_seq.load(std::memory_order_acquire);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(seq - pos);
+    if (diff == 0)
+    {
+      if (_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0) //上一轮的元素还没被取走, 队列满
+      return false;
+    else
+      pos = _enqueue_pos.load(std::memory_order_relaxed);
+  }
+  construct(c->data(), std::move(val));
+  c->_seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief 取出一个元素, 队列空时返回false
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @param out
+ * @return bool
+ */
+template <typename T, typename Alloc>
+bool mpmc_queue<T, Alloc>::try_pop(T &out)
+{
+  size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+  cell *c;
+  while (true)
+  {
+    c = &_buffer[pos & _mask];
+    size_type seq = c->_seq.load(std::memory_order_acquire);
+    ptrdiff_t diff = static_cast<ptrdiff_t>(seq - (pos + 1));
+    if (diff == 0)
+    {
+      if (_dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0) //此位置还没有被写入, 队列空
+      return false;
+    else
+      pos = _dequeue_pos.load(std::memory_order_relaxed);
+  }
+  out = std::move(*c->data());
+  destroy(c->data());
+  c->_seq.store(pos + _mask + 1, std::memory_order_release);
+  return true;
+}
+
+/**
+ * @brief 最多放入n个元素, 返回实际放入的个数
+ *        先从当前位置起数出连续可写的槽位, 再用一次CAS把它们一起抢下来
+ *        如果*first构造T可能抛出异常, 就退化为逐个try_push
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @tparam InputIter
+ * @param first
+ * @param n
+ * @return mpmc_queue<T, Alloc>::size_type
+ */
+template <typename T, typename Alloc>
+template <typename InputIter>
+typename mpmc_queue<T, Alloc>::size_type
+mpmc_queue<T, Alloc>::try_push_n(InputIter first, size_type n)
+{
+  using nothrow = typename std::conditional<
+      std::is_nothrow_constructible<T, decltype(*first)>::value,
+      _true_type, _false_type>::type;
+  return __try_push_n(first, n, nothrow());
+}
+
+template <typename T, typename Alloc>
+template <typename InputIter>
+typename mpmc_queue<T, Alloc>::size_type
+mpmc_queue<T, Alloc>::__try_push_n(InputIter first, size_type n, _false_type)
+{
+  size_type count = 0;
+  for (; count < n; ++count, ++first)
+    if (!try_push(*first))
+      break;
+  return count;
+}
+
+template <typename T, typename Alloc>
+template <typename InputIter>
+typename mpmc_queue<T, Alloc>::size_type
+mpmc_queue<T, Alloc>::__try_push_n(InputIter first, size_type n, _true_type)
+{
+  if (n == 0)
+    return 0;
+  size_type pos = _enqueue_pos.load(std::memory_order_relaxed);
+  size_type count;
+  while (true)
+  {
+    size_type seq = 0;
+    for (count = 0; count < n && count <= _mask; ++count)
+    {
+      seq = _buffer[(pos + count) & _mask]._seq.load(std::memory_order_acquire);
+      if (seq != pos + count)
+        break;
+    }
+    if (count != 0)
+    {
+      if (_enqueue_pos.compare_exchange_weak(pos, pos + count,
+                                             std::memory_order_relaxed))
+        break;
+    }
+    else if (static_cast<ptrdiff_t>(seq - pos) < 0)
+      return 0;
+    else
+      pos = _enqueue_pos.load(std::memory_order_relaxed);
+  }
+  for (size_type i = 0; i < count; ++i, ++first)
+  {
+    cell *c = &_buffer[(pos + i) & _mask];
+    construct(c->data(), *first);
+    c->_seq.store(pos + i + 1, std::memory_order_release);
+  }
+  return count;
+}
+
+/**
+ * @brief 最多取出n个元素写到res, 返回实际取出的个数, 同样只用一次CAS
+ *
+ * @tparam T
+ * @tparam Alloc
+ * @tparam OutputIter
+ * @param res
+ * @param n
+ * @return mpmc_queue<T, Alloc>::size_type
+ */
+template <typename T, typename Alloc>
+template <typename OutputIter>
+typename mpmc_queue<T, Alloc>::size_type
+mpmc_queue<T, Alloc>::try_pop_n(OutputIter res, size_type n)
+{
+  if (n == 0)
+    return 0;
+  size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+  size_type count;
+  while (true)
+  {
+    size_type seq = 0;
+    for (count = 0; count < n && count <= _mask; ++count)
+    {
+      seq = _buffer[(pos + count) & _mask]._seq.load(std::memory_order_acquire);
+      if (seq != pos + count + 1)
+        break;
+    }
+    if (count != 0)
+    {
+      if (_dequeue_pos.compare_exchange_weak(pos, pos + count,
+                                             std::memory_order_relaxed))
+        break;
+    }
+    else if (static_cast<ptrdiff_t>(seq - (pos + 1)) < 0)
+      return 0;
+    else
+      pos = _dequeue_pos.load(std::memory_order_relaxed);
+  }
+  for (size_type i = 0; i < count; ++i, ++res)
+  {
+    cell *c = &_buffer[(pos + i) & _mask];
+    *res = std::move(*c->data());
+    destroy(c->data());
+    c->_seq.store(pos + i + _mask + 1, std::memory_order_release);
+  }
+  return count;
+}
+
+/**
+ * @brief 析构剩余的元素并归还缓冲区, 调用时不能再有线程访问队列
+ *
+ * @tparam T
+ * @tparam Alloc
+ */
+template <typename T, typename Alloc>
+mpmc_queue<T, Alloc>::~mpmc_queue()
+{
+  const size_type tail = _enqueue_pos.load(std::memory_order_relaxed);
+  for (size_type pos = _dequeue_pos.load(std::memory_order_relaxed);
+       pos != tail; ++pos)
+    destroy(_buffer[pos & _mask].data());
+  for (size_type i = 0; i <= _mask; ++i)
+    _buffer[i]._seq.~atomic();
+  cell_allocator::deallocate(_buffer, capacity());
+}
+
+/**
+ * @brief 每个线程一个xorshift随机数发生器, 用于multi_queue随机选择子队列
+ *
+ * @return unsigned long long
+ */
+inline unsigned long long __thread_random()
+{
+  static std::atomic<unsigned long long> seed(0x9E3779B97F4A7C15ULL);
+  thread_local unsigned long long state =
+      seed.fetch_add(0x9E3779B97F4A7C15ULL, std::memory_order_relaxed) | 1;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+/**
+ * @brief 并发优先队列(MultiQueue), 语义是松弛的: pop不保证取到全局最优的元素
+ *        内部有queues个各自带锁的子堆, push随机选一个能立即锁上的子堆放入,
+ *        pop随机看choices个子堆(只用try_lock, 不会死锁), 取其中堆顶最优的那个
+ *        严格程度可配置: queues越少、choices越多，取出的元素越接近全局最优,
+ *        queues == 1时就是一把锁保护的普通优先队列;
+ *        通常取queues为线程数的2~4倍, choices为2
+ *        默认使用一级配置器，因为二级配置器的内存池不是线程安全的
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam Alloc
+ */
+template <typename T, typename Compare = jan::less<T>,
+          typename Alloc = jan::malloc_alloc>
+class multi_queue
+{
+public:
+  using value_type = T;
+  using size_type = size_t;
+  enum { MAX_CHOICES = 8 };
+
+  explicit multi_queue(size_type queues, size_type choices = 2,
+                       const Compare &comp = Compare());
+  multi_queue(const multi_queue &) = delete;
+  multi_queue &operator=(const multi_queue &) = delete;
+  ~multi_queue();
+
+  size_type queues() const { return _count; }
+  size_type size_approx() const
+  {
+    size_type n = 0;
+    for (size_type i = 0; i < _count; ++i)
+      n += _queues[i]._size.load(std::memory_order_relaxed);
+    return n;
+  }
+  bool empty() const { return size_approx() == 0; }
+
+  void push(const T &val) { emplace(val); }
+  void push(T &&val) { emplace(std::move(val)); }
+  template <typename... Args> void emplace(Args &&...args);
+  bool try_pop(T &out);
+
+private:
+  //子堆, 末尾的填充保证相邻子堆的锁和计数不在同一个缓存行
+  struct sub_queue
+  {
+    std::mutex _lock;
+    std::atomic<size_type> _size;
+    jan::vector<T, Alloc> _heap;
+    char _pad[_CACHE_LINE_SIZE];
+    sub_queue() : _size(0) {}
+  };
+  using queue_allocator = alloc_adapter<sub_queue, Alloc>;
+
+  void pop_locked(sub_queue &q, T &out)
+  {
+    jan::pop_heap(q._heap.begin(), q._heap.end(), _comp);
+    out = std::move(q._heap.back());
+    q._heap.pop_back();
+    q._size.store(q._heap.size(), std::memory_order_relaxed);
+  }
+
+  sub_queue *_queues;
+  size_type _count;
+  size_type _choices;
+  Compare _comp;
+};
+
+template <typename T, typename Compare, typename Alloc>
+multi_queue<T, Compare, Alloc>::multi_queue(size_type queues, size_type choices,
+                                            const Compare &comp)
+    : _count(queues), _choices(choices), _comp(comp)
+{
+  if (queues == 0)
+    throw std::invalid_argument("multi_queue needs at least one queue");
+  if (choices == 0 || choices > MAX_CHOICES)
+    throw std::invalid_argument("choices must be in [1, MAX_CHOICES]");
+  _queues = queue_allocator::allocate(_count);
+  for (size_type i = 0; i < _count; ++i)
+    new (&_queues[i]) sub_queue();
+}
+
+/**
+ * @brief 放入一个元素, 先在锁外构造好，
+ *        随机选子堆直到try_lock成功, 失败queues次之后就在最后选中的子堆上阻塞等待
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam Alloc
+ * @tparam Args
+ * @param args
+ */
+template <typename T, typename Compare, typename Alloc>
+template <typename... Args>
+void multi_queue<T, Compare, Alloc>::emplace(Args &&...args)
+{
+  T val(std::forward<Args>(args)...);
+  for (size_type tries = 0;; ++tries)
+  {
+    sub_queue &q = _queues[__thread_random() % _count];
+    std::unique_lock<std::mutex> lk(q._lock, std::try_to_lock);
+    if (!lk.owns_lock())
+    {
+      if (tries < _count)
+        continue;
+      lk.lock();
+    }
+    q._heap.emplace_back(std::move(val));
+    jan::push_heap(q._heap.begin(), q._heap.end(), _comp);
+    q._size.store(q._heap.size(), std::memory_order_relaxed);
+    return;
+  }
+}
+
+/**
+ * @brief 取出一个元素放到out中, 所有子堆都为空时返回false
+ *        每轮随机选choices个非空子堆并try_lock, 从锁上的子堆里取堆顶最优的一个;
+ *        连续queues轮都没有取到时, 从随机位置开始逐个加锁扫描所有子堆
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam Alloc
+ * @param out
+ * @return bool
+ */
+template <typename T, typename Compare, typename Alloc>
+bool multi_queue<T, Compare, Alloc>::try_pop(T &out)
+{
+  const size_type choices = _choices < _count ? _choices : _count;
+  for (size_type round = 0; round < _count; ++round)
+  {
+    std::unique_lock<std::mutex> locks[MAX_CHOICES];
+    size_type picked[MAX_CHOICES];
+    sub_queue *best = nullptr;
+    for (size_type k = 0; k < choices; ++k)
+    {
+      picked[k] = __thread_random() % _count;
+      bool seen = false;
+      for (size_type j = 0; j < k; ++j)
+        seen = seen || picked[j] == picked[k];
+      sub_queue &q = _queues[picked[k]];
+      if (seen || q._size.load(std::memory_order_relaxed) == 0)
+        continue;
+      locks[k] = std::unique_lock<std::mutex>(q._lock, std::try_to_lock);
+      if (!locks[k].owns_lock() || q._heap.empty())
+        continue;
+      if (best == nullptr || _comp(best->_heap.front(), q._heap.front()))
+        best = &q;
+    }
+    if (best != nullptr)
+    {
+      pop_locked(*best, out);
+      return true;
+    }
+  }
+  const size_type start = __thread_random() % _count;
+  for (size_type i = 0; i < _count; ++i)
+  {
+    sub_queue &q = _queues[(start + i) % _count];
+    if (q._size.load(std::memory_order_relaxed) == 0)
+      continue;
+    std::lock_guard<std::mutex> lk(q._lock);
+    if (q._heap.empty())
+      continue;
+    pop_locked(q, out);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief 析构所有子堆并释放内存, 调用时不能有其他线程在使用此队列
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam Alloc
+ */
+template <typename T, typename Compare, typename Alloc>
+multi_queue<T, Compare, Alloc>::~multi_queue()
+{
+  for (size_type i = 0; i < _count; ++i)
+    _queues[i].~sub_queue();
+  queue_allocator::deallocate(_queues, _count);
+}
+
+} // namespace jan
+
+#endif
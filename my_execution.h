@@ -0,0 +1,729 @@
+#ifndef __MY_EXECUTION_H_
+#define __MY_EXECUTION_H_
+
+#include "my_algorithm.h"
+#include "my_iterator.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jan {
+
+/**
+ * 执行策略, 作为算法的第一个参数:
+ *   jan::execution::seq        顺序执行, 与不带策略的版本相同
+ *   jan::execution::par        在线程池上并行执行
+ *   jan::execution::par_unseq  同par, 允许每个线程内部向量化
+ * par.with_threads(n)可以限制最多使用的线程数, 用于测试扩展性
+ * par版本要求随机访问迭代器
+ */
+namespace execution {
+
+struct sequenced_policy {
+};
+
+struct parallel_policy {
+  size_t _threads = 0; // 0表示使用线程池中的全部线程
+  parallel_policy with_threads(size_t n) const
+  {
+    parallel_policy ret(*this);
+    ret._threads = n;
+    return ret;
+  }
+};
+
+struct parallel_unsequenced_policy : parallel_policy {
+};
+
+const sequenced_policy seq{};
+const parallel_policy par{};
+const parallel_unsequenced_policy par_unseq{};
+
+} // namespace execution
+
+//用于限制以策略为模板参数的重载, 避免与不带策略的同名算法冲突
+template <typename T> struct is_execution_policy {
+  static const bool value =
+      std::is_same<T, execution::sequenced_policy>::value ||
+      std::is_base_of<execution::parallel_policy, T>::value;
+};
+
+/**
+ * @brief 算法内部使用的线程池, 第一次使用时创建hardware_concurrency() - 1个工作线程,
+ *        调用者自己也参与计算
+ *        run(chunks, f)把块0..chunks-1静态地分给各个线程: 第w个线程依次执行w, w+P, w+2P...
+ *        任何一块抛出的异常在所有线程结束后在调用者线程中重新抛出(只保留第一个),
+ *        出现异常后尚未开始的块不再执行
+ *        在池中的线程里再次调用run(嵌套的并行算法)时直接在当前线程顺序执行, 不会死锁
+ *
+ */
+class _thread_pool
+{
+public:
+  static _thread_pool &instance()
+  {
+    static _thread_pool pool;
+    return pool;
+  }
+  size_t size() const { return _workers.size() + 1; }
+
+  template <typename F> void run(size_t chunks, F &f);
+
+private:
+  _thread_pool() : _job(nullptr), _invoke(nullptr), _chunks(0), _generation(0),
+                   _pending(0), _failed(false), _stop(false)
+  {
+    size_t n = std::thread::hardware_concurrency();
+    for (size_t id = 1; id < n; ++id)
+      _workers.emplace_back(&_thread_pool::worker_loop, this, id);
+  }
+  ~_thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lk(_lock);
+      _stop = true;
+    }
+    _wake.notify_all();
+    for (auto &t : _workers)
+      t.join();
+  }
+  _thread_pool(const _thread_pool &) = delete;
+  _thread_pool &operator=(const _thread_pool &) = delete;
+
+  static bool &in_pool()
+  {
+    thread_local bool flag = false;
+    return flag;
+  }
+  template <typename F> static void invoke(void *job, size_t chunk)
+  {
+    (*static_cast<F *>(job))(chunk);
+  }
+  void execute(size_t id);
+  void worker_loop(size_t id);
+
+  std::vector<std::thread> _workers;
+  std::mutex _run_lock; // 不同的外部线程同时调用run时排队
+  std::mutex _lock;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+  void *_job;
+  void (*_invoke)(void *, size_t);
+  size_t _chunks;
+  size_t _generation;
+  size_t _pending;
+  std::atomic<bool> _failed;
+  std::exception_ptr _error;
+  bool _stop;
+};
+
+/**
+ * @brief 第id个线程执行属于它的块, 捕获异常
+ *
+ * @param id
+ */
+inline void _thread_pool::execute(size_t id)
+{
+  const size_t stride = size();
+  for (size_t c = id; c < _chunks; c += stride)
+  {
+    if (_failed.load(std::memory_order_relaxed))
+      return;
+    try
+    {
+      _invoke(_job, c);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lk(_lock);
+      if (!_error)
+        _error = std::current_exception();
+      _failed.store(true, std::memory_order_relaxed);
+    }
+  }
+}
+
+inline void _thread_pool::worker_loop(size_t id)
+{
+  in_pool() = true;
+  size_t seen = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lk(_lock);
+      _wake.wait(lk, [&] { return _stop || _generation != seen; });
+      if (_stop)
+        return;
+      seen = _generation;
+    }
+    execute(id);
+    std::lock_guard<std::mutex> lk(_lock);
+    if (--_pending == 0)
+      _done.notify_one();
+  }
+}
+
+/**
+ * @brief 并行执行f(0), f(1), ... f(chunks - 1), 全部完成后返回
+ *
+ * @tparam F
+ * @param chunks
+ * @param f
+ */
+template <typename F> void _thread_pool::run(size_t chunks, F &f)
+{
+  if (chunks == 0)
+    return;
+  if (chunks == 1 || _workers.empty() || in_pool())
+  {
+    for (size_t c = 0; c < chunks; ++c)
+      f(c);
+    return;
+  }
+  std::lock_guard<std::mutex> serial(_run_lock);
+  {
+    std::lock_guard<std::mutex> lk(_lock);
+    _job = &f;
+    _invoke = &_thread_pool::invoke<F>;
+    _chunks = chunks;
+    _error = nullptr;
+    _failed.store(false, std::memory_order_relaxed);
+    _pending = _workers.size();
+    ++_generation;
+  }
+  _wake.notify_all();
+  in_pool() = true;
+  execute(0);
+  in_pool() = false;
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lk(_lock);
+    _done.wait(lk, [&] { return _pending == 0; });
+    error = _error;
+    _error = nullptr;
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+//区间短于此值时不值得唤醒线程池, 直接顺序执行
+enum { __PARALLEL_THRESHOLD = 1 << 15 };
+
+/**
+ * @brief 把长度为n的区间平均切成若干块, 块数不超过策略允许的线程数
+ *
+ * @param policy
+ * @param n
+ * @return size_t 块数, 为1时调用者应当顺序执行
+ */
+inline size_t __parallel_chunks(const execution::parallel_policy &policy, size_t n)
+{
+  if (n < __PARALLEL_THRESHOLD)
+    return 1;
+  size_t threads = _thread_pool::instance().size();
+  if (policy._threads != 0 && policy._threads < threads)
+    threads = policy._threads;
+  return threads;
+}
+
+//第c块的范围是[n * c / chunks, n * (c + 1) / chunks)
+inline size_t __chunk_begin(size_t n, size_t c, size_t chunks)
+{
+  return static_cast<size_t>(static_cast<unsigned long long>(n) * c / chunks);
+}
+
+/**
+ * @brief 把[0,n)切块后并行执行f(begin, end), 块数为1时直接在当前线程执行
+ *
+ * @tparam F
+ * @param policy
+ * @param n
+ * @param f
+ */
+template <typename F>
+void __parallel_for(const execution::parallel_policy &policy, size_t n, F f)
+{
+  const size_t chunks = __parallel_chunks(policy, n);
+  auto task = [&](size_t c) {
+    f(__chunk_begin(n, c, chunks), __chunk_begin(n, c + 1, chunks));
+  };
+  _thread_pool::instance().run(chunks, task);
+}
+
+/**
+ * @brief 并行归约: 每块用partial(begin, end)算出局部结果, 再按块的顺序用op合并到init
+ *        要求op满足结合律
+ *
+ * @tparam T
+ * @tparam Partial
+ * @tparam BinaryOp
+ * @param policy
+ * @param n
+ * @param init
+ * @param partial
+ * @param op
+ * @return T
+ */
+template <typename T> struct __reduce_slot {
+  T val; //包一层, 避免T为bool时vector<bool>的多个元素共用一个字节
+};
+
+template <typename T, typename Partial, typename BinaryOp>
+T __parallel_reduce(const execution::parallel_policy &policy, size_t n, T init,
+                    Partial partial, BinaryOp op)
+{
+  const size_t chunks = __parallel_chunks(policy, n);
+  std::vector<__reduce_slot<T>> results(chunks, __reduce_slot<T>{init});
+  auto task = [&](size_t c) {
+    size_t b = __chunk_begin(n, c, chunks), e = __chunk_begin(n, c + 1, chunks);
+    if (b != e)
+      results[c].val = partial(b, e);
+  };
+  _thread_pool::instance().run(chunks, task);
+  for (size_t c = 0; c < chunks; ++c)
+    if (__chunk_begin(n, c, chunks) != __chunk_begin(n, c + 1, chunks))
+      init = op(init, results[c].val);
+  return init;
+}
+
+/************accumulate***********/
+
+template <typename InputIter, typename T, typename BinaryOp>
+inline T accumulate(const execution::sequenced_policy &, InputIter first,
+                    InputIter last, T init, BinaryOp op)
+{
+  return jan::accumulate(first, last, init, op);
+}
+
+/**
+ * @brief 并行求和, 各块的局部和按顺序合并, op需要满足结合律(浮点数的结果可能与顺序求和略有不同)
+ *
+ * @tparam RandomIter
+ * @tparam T
+ * @tparam BinaryOp
+ * @param policy
+ * @param first
+ * @param last
+ * @param init
+ * @param op
+ * @return T
+ */
+template <typename RandomIter, typename T, typename BinaryOp>
+T accumulate(const execution::parallel_policy &policy, RandomIter first,
+             RandomIter last, T init, BinaryOp op)
+{
+  return jan::__parallel_reduce(policy, last - first, init,
+                                [&](size_t b, size_t e) {
+                                  T ret = *(first + b);
+                                  return jan::accumulate(first + b + 1, first + e, ret, op);
+                                },
+                                op);
+}
+
+template <typename Policy, typename InputIter, typename T>
+inline typename std::enable_if<is_execution_policy<Policy>::value, T>::type
+accumulate(const Policy &policy, InputIter first, InputIter last, T init)
+{
+  return jan::accumulate(policy, first, last, init, jan::plus<T>());
+}
+
+/************inner_product***********/
+
+template <typename InputIter1, typename InputIter2, typename T, typename BinaryOp>
+inline T inner_product(const execution::sequenced_policy &, InputIter1 first1,
+                       InputIter1 last1, InputIter2 first2, T init, BinaryOp op)
+{
+  return jan::inner_product(first1, last1, first2, init, op);
+}
+
+/**
+ * @brief 并行内积, init += op(*first1, *first2), op的默认值为乘法
+ *
+ * @tparam RandomIter1
+ * @tparam RandomIter2
+ * @tparam T
+ * @tparam BinaryOp
+ * @param policy
+ * @param first1
+ * @param last1
+ * @param first2
+ * @param init
+ * @param op
+ * @return T
+ */
+template <typename RandomIter1, typename RandomIter2, typename T, typename BinaryOp>
+T inner_product(const execution::parallel_policy &policy, RandomIter1 first1,
+                RandomIter1 last1, RandomIter2 first2, T init, BinaryOp op)
+{
+  return jan::__parallel_reduce(policy, last1 - first1, init,
+                                [&](size_t b, size_t e) {
+                                  T ret = op(*(first1 + b), *(first2 + b));
+                                  return jan::inner_product(first1 + b + 1, first1 + e,
+                                                            first2 + b + 1, ret, op);
+                                },
+                                jan::plus<T>());
+}
+
+template <typename T> struct __multiplies {
+  template <typename U, typename V> T operator()(const U &a, const V &b) const
+  {
+    return a * b;
+  }
+};
+
+template <typename Policy, typename InputIter1, typename InputIter2, typename T>
+inline typename std::enable_if<is_execution_policy<Policy>::value, T>::type
+inner_product(const Policy &policy, InputIter1 first1, InputIter1 last1,
+              InputIter2 first2, T init)
+{
+  return jan::inner_product(policy, first1, last1, first2, init, __multiplies<T>());
+}
+
+/************count / count_if***********/
+
+template <typename InputIter, typename Predicate>
+inline typename iterator_traits<InputIter>::difference_type
+count_if(const execution::sequenced_policy &, InputIter first, InputIter last,
+         Predicate pred)
+{
+  return jan::count_if(first, last, pred);
+}
+
+template <typename RandomIter, typename Predicate>
+typename iterator_traits<RandomIter>::difference_type
+count_if(const execution::parallel_policy &policy, RandomIter first,
+         RandomIter last, Predicate pred)
+{
+  using Distance = typename iterator_traits<RandomIter>::difference_type;
+  return jan::__parallel_reduce(policy, last - first, Distance(0),
+                                [&](size_t b, size_t e) {
+                                  return jan::count_if(first + b, first + e, pred);
+                                },
+                                jan::plus<Distance>());
+}
+
+template <typename Policy, typename InputIter, typename T>
+inline typename std::enable_if<is_execution_policy<Policy>::value,
+                               typename iterator_traits<InputIter>::difference_type>::type
+count(const Policy &policy, InputIter first, InputIter last, const T &val)
+{
+  return jan::count_if(policy, first, last,
+                       [&val](const typename iterator_traits<InputIter>::value_type &x) {
+                         return x == val;
+                       });
+}
+
+/************find / find_if***********/
+
+template <typename InputIter, typename Predicate>
+inline InputIter find_if(const execution::sequenced_policy &, InputIter first,
+                         InputIter last, Predicate pred)
+{
+  return jan::find_if(first, last, pred);
+}
+
+/**
+ * @brief 并行查找第一个满足pred的元素
+ *        区间切成线程数8倍的小块, 已经找到的最小位置记录在一个原子变量里,
+ *        起点在它之后的块直接跳过, 块内也会定期检查以便提前结束
+ *
+ * @tparam RandomIter
+ * @tparam Predicate
+ * @param policy
+ * @param first
+ * @param last
+ * @param pred
+ * @return RandomIter
+ */
+template <typename RandomIter, typename Predicate>
+RandomIter find_if(const execution::parallel_policy &policy, RandomIter first,
+                   RandomIter last, Predicate pred)
+{
+  const size_t n = last - first;
+  const size_t threads = __parallel_chunks(policy, n);
+  if (threads == 1)
+    return jan::find_if(first, last, pred);
+  const size_t chunks = threads * 8;
+  std::atomic<size_t> found(n);
+  auto task = [&](size_t c) {
+    const size_t b = __chunk_begin(n, c, chunks), e = __chunk_begin(n, c + 1, chunks);
+    for (size_t i = b; i < e; ++i)
+    {
+      if ((i & 1023) == 0 && found.load(std::memory_order_relaxed) < b)
+        return;
+      if (pred(*(first + i)))
+      {
+        size_t cur = found.load(std::memory_order_relaxed);
+        while (i < cur && !found.compare_exchange_weak(cur, i))
+          ;
+        return;
+      }
+    }
+  };
+  _thread_pool::instance().run(chunks, task);
+  return first + found.load();
+}
+
+template <typename Policy, typename InputIter, typename T>
+inline typename std::enable_if<is_execution_policy<Policy>::value, InputIter>::type
+find(const Policy &policy, InputIter first, InputIter last, const T &val)
+{
+  return jan::find_if(policy, first, last,
+                      [&val](const typename iterator_traits<InputIter>::value_type &x) {
+                        return x == val;
+                      });
+}
+
+/************for_each / fill / copy***********/
+
+template <typename InputIter, typename F>
+inline void for_each(const execution::sequenced_policy &, InputIter first,
+                     InputIter last, F f)
+{
+  jan::for_each(first, last, f);
+}
+
+/**
+ * @brief 并行地对每个元素调用f, 每个线程使用f的一份拷贝
+ *
+ * @tparam RandomIter
+ * @tparam F
+ * @param policy
+ * @param first
+ * @param last
+ * @param f
+ */
+template <typename RandomIter, typename F>
+void for_each(const execution::parallel_policy &policy, RandomIter first,
+              RandomIter last, F f)
+{
+  jan::__parallel_for(policy, last - first, [&](size_t b, size_t e) {
+    jan::for_each(first + b, first + e, f);
+  });
+}
+
+template <typename ForwardIter, typename T>
+inline void fill(const execution::sequenced_policy &, ForwardIter first,
+                 ForwardIter last, const T &val)
+{
+  jan::fill(first, last, val);
+}
+
+template <typename RandomIter, typename T>
+void fill(const execution::parallel_policy &policy, RandomIter first,
+          RandomIter last, const T &val)
+{
+  jan::__parallel_for(policy, last - first, [&](size_t b, size_t e) {
+    jan::fill(first + b, first + e, val);
+  });
+}
+
+template <typename InputIter, typename OutputIter>
+inline OutputIter copy(const execution::sequenced_policy &, InputIter first,
+                       InputIter last, OutputIter res)
+{
+  return jan::copy(first, last, res);
+}
+
+/**
+ * @brief 并行拷贝, 每块仍然调用jan::copy, 所以指针区间会走memmove
+ *        源区间与目标区间不能重叠
+ *
+ * @tparam RandomIter
+ * @tparam OutputIter
+ * @param policy
+ * @param first
+ * @param last
+ * @param res
+ * @return OutputIter
+ */
+template <typename RandomIter, typename OutputIter>
+OutputIter copy(const execution::parallel_policy &policy, RandomIter first,
+                RandomIter last, OutputIter res)
+{
+  const size_t n = last - first;
+  jan::__parallel_for(policy, n, [&](size_t b, size_t e) {
+    jan::copy(first + b, first + e, res + b);
+  });
+  return res + n;
+}
+
+/************inclusive_scan / exclusive_scan***********/
+
+template <typename InputIter, typename OutputIter, typename BinaryOp>
+inline OutputIter inclusive_scan(const execution::sequenced_policy &, InputIter first,
+                                 InputIter last, OutputIter res, BinaryOp op)
+{
+  return jan::inclusive_scan(first, last, res, op);
+}
+
+template <typename InputIter, typename OutputIter, typename BinaryOp, typename T>
+inline OutputIter inclusive_scan(const execution::sequenced_policy &, InputIter first,
+                                 InputIter last, OutputIter res, BinaryOp op, T init)
+{
+  return jan::inclusive_scan(first, last, res, op, init);
+}
+
+template <typename InputIter, typename OutputIter, typename T, typename BinaryOp>
+inline OutputIter exclusive_scan(const execution::sequenced_policy &, InputIter first,
+                                 InputIter last, OutputIter res, T init, BinaryOp op)
+{
+  return jan::exclusive_scan(first, last, res, init, op);
+}
+
+/**
+ * @brief 并行前缀和, 先归约再扫描, 总共读两遍输入、写一遍输出:
+ *          1. 除最后一块外, 每块并行地求出自己所有元素的op之和
+ *          2. 在当前线程按块的顺序把这些和累积起来, 得到进入每一块之前的前缀
+ *          3. 每块以这个前缀为初值并行地做顺序扫描(整数加法时是向量化的扫描)
+ *        op需要满足结合律; 第1步读完所有输入之后第3步才开始写, 所以res可以等于first,
+ *        其它情况下两个区间不能重叠
+ *
+ * @tparam RandomIter
+ * @tparam OutputIter
+ * @tparam BinaryOp
+ * @tparam T
+ * @param policy
+ * @param first
+ * @param last
+ * @param res
+ * @param op
+ * @param init 为nullptr时没有初值(只有inclusive可以没有)
+ * @param exclusive
+ * @return OutputIter 写完后的res
+ */
+template <typename RandomIter, typename OutputIter, typename BinaryOp, typename T>
+OutputIter __parallel_scan(const execution::parallel_policy &policy, RandomIter first,
+                           RandomIter last, OutputIter res, BinaryOp op, const T *init,
+                           bool exclusive)
+{
+  const size_t n = last - first;
+  const size_t chunks = __parallel_chunks(policy, n);
+  if (chunks == 1)
+  {
+    if (exclusive)
+      return jan::exclusive_scan(first, last, res, *init, op);
+    return init ? jan::inclusive_scan(first, last, res, op, *init)
+                : jan::inclusive_scan(first, last, res, op);
+  }
+  std::vector<__reduce_slot<T>> prefix(chunks - 1, __reduce_slot<T>{T(*first)});
+  auto reduce_task = [&](size_t c) {
+    size_t b = __chunk_begin(n, c, chunks), e = __chunk_begin(n, c + 1, chunks);
+    prefix[c].val = jan::accumulate(first + b + 1, first + e, T(*(first + b)), op);
+  };
+  _thread_pool::instance().run(chunks - 1, reduce_task);
+  //prefix[c]变为前c+1块(以及init)的和, 也就是第c+1块的初值
+  if (init)
+    prefix[0].val = op(*init, prefix[0].val);
+  for (size_t c = 1; c + 1 < chunks; ++c)
+    prefix[c].val = op(prefix[c - 1].val, prefix[c].val);
+  auto scan_task = [&](size_t c) {
+    size_t b = __chunk_begin(n, c, chunks), e = __chunk_begin(n, c + 1, chunks);
+    if (c == 0 && !init)
+      jan::inclusive_scan(first, first + e, res, op);
+    else
+    {
+      const T &carry = c == 0 ? *init : prefix[c - 1].val;
+      if (exclusive)
+        jan::exclusive_scan(first + b, first + e, res + b, carry, op);
+      else
+        jan::inclusive_scan(first + b, first + e, res + b, op, carry);
+    }
+  };
+  _thread_pool::instance().run(chunks, scan_task);
+  return res + n;
+}
+
+template <typename RandomIter, typename OutputIter, typename BinaryOp>
+inline OutputIter inclusive_scan(const execution::parallel_policy &policy, RandomIter first,
+                                 RandomIter last, OutputIter res, BinaryOp op)
+{
+  typedef typename iterator_traits<RandomIter>::value_type T;
+  return jan::__parallel_scan(policy, first, last, res, op, static_cast<const T *>(nullptr),
+                              false);
+}
+
+template <typename RandomIter, typename OutputIter, typename BinaryOp, typename T>
+inline OutputIter inclusive_scan(const execution::parallel_policy &policy, RandomIter first,
+                                 RandomIter last, OutputIter res, BinaryOp op, T init)
+{
+  return jan::__parallel_scan(policy, first, last, res, op, &init, false);
+}
+
+template <typename RandomIter, typename OutputIter, typename T, typename BinaryOp>
+inline OutputIter exclusive_scan(const execution::parallel_policy &policy, RandomIter first,
+                                 RandomIter last, OutputIter res, T init, BinaryOp op)
+{
+  return jan::__parallel_scan(policy, first, last, res, op, &init, true);
+}
+
+template <typename Policy, typename InputIter, typename OutputIter>
+inline typename std::enable_if<is_execution_policy<Policy>::value, OutputIter>::type
+inclusive_scan(const Policy &policy, InputIter first, InputIter last, OutputIter res)
+{
+  typedef typename iterator_traits<InputIter>::value_type T;
+  return jan::inclusive_scan(policy, first, last, res, jan::plus<T>());
+}
+
+template <typename Policy, typename InputIter, typename OutputIter, typename T>
+inline typename std::enable_if<is_execution_policy<Policy>::value, OutputIter>::type
+exclusive_scan(const Policy &policy, InputIter first, InputIter last, OutputIter res,
+               T init)
+{
+  return jan::exclusive_scan(policy, first, last, res, init, jan::plus<T>());
+}
+
+/************adjacent_difference***********/
+
+template <typename InputIter, typename OutputIter, typename BinaryOp>
+inline OutputIter adjacent_difference(const execution::sequenced_policy &, InputIter first,
+                                      InputIter last, OutputIter res, BinaryOp op)
+{
+  return jan::adjacent_difference(first, last, res, op);
+}
+
+/**
+ * @brief 并行相邻差, 每块开头的元素直接读前一块的最后一个元素
+ *        块边界上的元素会被两个线程读到, 所以res不能与[first,last)重叠
+ *
+ * @tparam RandomIter
+ * @tparam OutputIter
+ * @tparam BinaryOp
+ * @param policy
+ * @param first
+ * @param last
+ * @param res
+ * @param op
+ * @return OutputIter 写完后的res
+ */
+template <typename RandomIter, typename OutputIter, typename BinaryOp>
+OutputIter adjacent_difference(const execution::parallel_policy &policy, RandomIter first,
+                               RandomIter last, OutputIter res, BinaryOp op)
+{
+  const size_t n = last - first;
+  jan::__parallel_for(policy, n, [&](size_t b, size_t e) {
+    if (b == 0)
+      jan::adjacent_difference(first, first + e, res, op);
+    else
+      for (size_t i = b; i < e; ++i)
+        *(res + i) = op(*(first + i), *(first + (i - 1)));
+  });
+  return res + n;
+}
+
+template <typename Policy, typename InputIter, typename OutputIter>
+inline typename std::enable_if<is_execution_policy<Policy>::value, OutputIter>::type
+adjacent_difference(const Policy &policy, InputIter first, InputIter last, OutputIter res)
+{
+  typedef typename iterator_traits<InputIter>::value_type T;
+  return jan::adjacent_difference(policy, first, last, res, jan::minus<T>());
+}
+
+} // namespace jan
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __MY_FUNCTIONAL_H_
+#define __MY_FUNCTIONAL_H_
+
+namespace jan {
+
+/**
+ * @brief 默认的比较仿函数, 算法和容器中不带comp的版本都使用它
+ *
+ * @tparam T
+ */
+template <typename T> struct less {
+  bool operator()(const T &a, const T &b) const { return a < b; }
+};
+
+template <typename T> struct greater {
+  bool operator()(const T &a, const T &b) const { return a > b; }
+};
+
+/**
+ * @brief 加法和减法仿函数, 前缀和与相邻差不带op的版本分别使用它们
+ *        算法看到jan::plus<T>时知道op就是加法, 可以改用向量化的实现
+ *
+ * @tparam T
+ */
+template <typename T> struct plus {
+  T operator()(const T &a, const T &b) const { return a + b; }
+};
+
+template <typename T> struct minus {
+  T operator()(const T &a, const T &b) const { return a - b; }
+};
+
+} // namespace jan
+
+#endif
@@ -1,140 +1,271 @@
 #ifndef __MY_HEAP_
 #define __MY_HEAP_
 #include "my_iterator.h"
+#include "my_functional.h"
+#include <cstddef>
+#include <utility>
 namespace jan
 {
 
-	template <typename RandomIter, typename Distance, typename T>
-	void __push_heap(RandomIter first, Distance holdIdx, Distance topInx, const T & val)
+/**
+ * 堆算法一族: push_heap, pop_heap, make_heap, sort_heap, is_heap
+ * 都有带comp和不带comp两个版本，不带comp的使用jan::less, 得到大根堆(与std一致)
+ * 模板参数D为堆的叉数，默认是二叉堆, 例如 jan::push_heap<4>(first, last, comp)
+ * 4叉堆的高度是二叉堆的一半，一个节点的4个孩子相邻，通常落在同一个缓存行里
+ * 同一个区间必须始终使用同一个D
+ * 调整过程中元素都是移动而不是拷贝的
+ */
+
+/**
+ * @brief 元素被放到堆中某个位置后的回调, 普通的堆不关心位置，什么也不做
+ *        索引堆用它来维护句柄到位置的映射, 见my_queue.h中的indexed_heap
+ * 
+ */
+struct __heap_no_notify
+{
+	template <typename T, typename Distance>
+	void operator()(T &, Distance) const { }
+};
+
+	/**
+	 * @brief 将val从holdIdx处向上调整，直到topIdx为止
+	 * 
+	 * @tparam D 
+	 * @tparam RandomIter 
+	 * @tparam Distance 
+	 * @tparam T 
+	 * @tparam Compare 
+	 * @param first 	容器的首迭代器
+	 * @param holdIdx 	空洞的位置
+	 * @param topIdx 	最多上溯到的位置
+	 * @param val 		要放入的值
+	 * @param comp 
+	 * @param notify 	每个元素落到新位置后调用notify(元素, 位置)
+	 */
+	template <size_t D, typename RandomIter, typename Distance, typename T, typename Compare,
+				typename Notify = __heap_no_notify>
+	void __push_heap(RandomIter first, Distance holdIdx, Distance topIdx, T val, Compare comp,
+						Notify notify = Notify())
 	{
-		Distance parent = (holdIdx - 1) / 2;
-		while(holdIdx > topInx && val > *(first + parent))
+		Distance parent = (holdIdx - 1) / D;
+		while(holdIdx > topIdx && comp(*(first + parent), val))
 		{
-			*(first + holdIdx) = *(first + parent);
+			*(first + holdIdx) = std::move(*(first + parent));
+			notify(*(first + holdIdx), holdIdx);
 			holdIdx = parent;
-			parent = (holdIdx - 1) / 2;
+			parent = (holdIdx - 1) / D;
 		}
-		*(first + holdIdx) = val;
+		*(first + holdIdx) = std::move(val);
+		notify(*(first + holdIdx), holdIdx);
 	}
-template <typename RandomIter, typename Distance, typename T>
-inline void __push_heap_aux(RandomIter first, RandomIter last, Distance *, T *)
+template <size_t D, typename RandomIter, typename Distance, typename T, typename Compare>
+inline void __push_heap_aux(RandomIter first, RandomIter last, Distance *, T *, Compare comp)
 {
-    __push_heap(first,
+    jan::__push_heap<D>(first,
             static_cast<Distance>((last - first - 1)),
             static_cast<Distance>(0),
-            T(*(last - 1)));
+            T(std::move(*(last - 1))), comp);
 }
 
+/**
+ * @brief 新元素已经放在last-1处，将其上溯到合适的位置
+ * 
+ * @tparam D 
+ * @tparam RandomIter 
+ * @tparam Compare 
+ * @param first 
+ * @param last 
+ * @param comp 
+ */
+template <size_t D = 2, typename RandomIter, typename Compare>
+inline void push_heap(RandomIter first, RandomIter last, Compare comp)
+{
+	static_assert(D >= 2, "heap arity must be at least 2");
+	jan::__push_heap_aux<D>(first,last,distance_type(first),value_type(first),comp);
+}
 
-template <typename RandomIter>
+template <size_t D = 2, typename RandomIter>
 inline void push_heap(RandomIter first, RandomIter last)
 {
-	__push_heap_aux(first,last,distance_type(first),value_type(first));
+	using T = typename iterator_traits<RandomIter>::value_type;
+	jan::push_heap<D>(first,last,jan::less<T>());
 }
 
 
 
 
 /**
- * @brief  调整一个根节点不遵守规则的大根堆
+ * @brief  调整一个根节点不遵守规则的堆, 在D个孩子中选出最大的一个来填补空洞
  * 
+ * @tparam D 
  * @tparam RandomIter 
  * @tparam Distance 
  * @tparam T 
+ * @tparam Compare 
  * @param first 	容器的首迭代器
  * @param holdIdx 	区间起始
  * @param len 		容器头到区间结束的长度
  * @param val 		根节点的值
+ * @param comp 
+ * @param notify 	每个元素落到新位置后调用notify(元素, 位置)
  */
-template <typename RandomIter, typename Distance, typename T>
-void __adjust_heap(RandomIter first, Distance holdIdx, Distance len, T  val)
+template <size_t D, typename RandomIter, typename Distance, typename T, typename Compare,
+			typename Notify = __heap_no_notify>
+void __adjust_heap(RandomIter first, Distance holdIdx, Distance len, T  val, Compare comp,
+					Notify notify = Notify())
 {
-	Distance topIdx = holdIdx;
-	Distance child = holdIdx * 2 + 1;
+	Distance child = holdIdx * D + 1;
 	while (child < len)
 	{
-		if(child < len - 1 && *(first + child + 1) > *(first + child))
-			++child;
-		if(val >= *(first + child))
+		Distance best = child;
+		Distance end = len - child > static_cast<Distance>(D) ? child + D : len;
+		for(Distance i = child + 1; i < end; ++i)
+			if(comp(*(first + best), *(first + i)))
+				best = i;
+		if(!comp(val, *(first + best)))
 			break;
-		*(first + holdIdx) = *(first + child);
-		holdIdx = child;
-		child = holdIdx * 2 + 1;
+		*(first + holdIdx) = std::move(*(first + best));
+		notify(*(first + holdIdx), holdIdx);
+		holdIdx = best;
+		child = holdIdx * D + 1;
 	}
-	*(first + holdIdx) = val;
+	*(first + holdIdx) = std::move(val);
+	notify(*(first + holdIdx), holdIdx);
 }
 
 
 /**
  * @brief 
  * 
+ * @tparam D 
  * @tparam RandomIter 
  * @tparam T 
+ * @tparam Compare 
  * @tparam Distance 
  * @param first 容器首迭代器
  * @param last 	容器尾迭代器
  * @param res 	将顶部元素pop后放到哪里
  * @param val 	被上溯的元素
+ * @param comp 
  */
-template <typename RandomIter, typename T, typename Distance>
+template <size_t D, typename RandomIter, typename T, typename Compare, typename Distance>
 inline void __pop_heap(RandomIter first, RandomIter last, RandomIter res,
-										 T val, Distance *)
+										 T val, Compare comp, Distance *)
 {
-	*res = *first;	//将队首元素赋值响应的地方
-	__adjust_heap(first,Distance(0),Distance(last - first),val);
+	*res = std::move(*first);	//将队首元素移到相应的地方
+	jan::__adjust_heap<D>(first,Distance(0),Distance(last - first),std::move(val),comp);
 }
 
-template <typename RandomIter, typename T>
-inline void __pop_heap_aux(RandomIter first, RandomIter last, T*)
+template <size_t D, typename RandomIter, typename T, typename Compare>
+inline void __pop_heap_aux(RandomIter first, RandomIter last, T*, Compare comp)
 {
 	//第一个last-1表示：将顶部节点放到最尾后，这个调整堆的时候尾部迭代器要向前移动
 	//第二个last-1表示，将顶部的值复制到last-1出，即原先的尾端
-	__pop_heap(first,last-1,last-1,T(*(last-1)),distance_type(first));
+	jan::__pop_heap<D>(first,last-1,last-1,T(std::move(*(last-1))),comp,distance_type(first));
+}
+
+/**
+ * @brief 将堆顶元素移到last-1处, [first,last-1)仍然是一个堆
+ * 
+ * @tparam D 
+ * @tparam RandomIter 
+ * @tparam Compare 
+ * @param first 
+ * @param last 
+ * @param comp 
+ */
+template <size_t D = 2, typename RandomIter, typename Compare>
+inline void pop_heap(RandomIter first, RandomIter last, Compare comp)
+{
+	static_assert(D >= 2, "heap arity must be at least 2");
+	if(last - first < 2)
+		return;
+	jan::__pop_heap_aux<D>(first,last,value_type(first),comp);
 }
-template <typename RandomIter>
+
+template <size_t D = 2, typename RandomIter>
 inline void pop_heap(RandomIter first, RandomIter last)
 {
-	__pop_heap_aux(first,last,value_type(first));
+	using T = typename iterator_traits<RandomIter>::value_type;
+	jan::pop_heap<D>(first,last,jan::less<T>());
 }
 
-template <typename RandomIter>
-inline void sort_heap(RandomIter first, RandomIter last)
+template <size_t D = 2, typename RandomIter, typename Compare>
+inline void sort_heap(RandomIter first, RandomIter last, Compare comp)
 {
 	while(last - first > 1)
 	{
-		jan::pop_heap(first,last--);
+		jan::pop_heap<D>(first,last--,comp);
 	}
 }
 
-template <typename RandomIter, typename T, typename Distance>
-inline void __make_heap(RandomIter first, RandomIter last, T *, Distance *)
+template <size_t D = 2, typename RandomIter>
+inline void sort_heap(RandomIter first, RandomIter last)
+{
+	using T = typename iterator_traits<RandomIter>::value_type;
+	jan::sort_heap<D>(first,last,jan::less<T>());
+}
+
+template <size_t D, typename RandomIter, typename T, typename Compare, typename Distance>
+inline void __make_heap(RandomIter first, RandomIter last, Compare comp, T *, Distance *)
 {
 	if(last - first < 2)
 		return;
 	Distance len = last - first;
-	Distance holdIdx = (len - 2) / 2;
+	//最后一个有孩子的节点
+	Distance holdIdx = (len - 2) / D;
 	while(holdIdx >= 0)
 	{
-		__adjust_heap(first,holdIdx,len,T(*(first + holdIdx)));
+		jan::__adjust_heap<D>(first,holdIdx,len,T(std::move(*(first + holdIdx))),comp);
 		--holdIdx;
 	}
 }
 
-template <typename RandomIter>
-inline void make_heap(RandomIter first, RandomIter last)
+template <size_t D = 2, typename RandomIter, typename Compare>
+inline void make_heap(RandomIter first, RandomIter last, Compare comp)
 {
-	__make_heap(first,last,value_type(first),distance_type(first));
+	static_assert(D >= 2, "heap arity must be at least 2");
+	jan::__make_heap<D>(first,last,comp,value_type(first),distance_type(first));
 }
 
+template <size_t D = 2, typename RandomIter>
+inline void make_heap(RandomIter first, RandomIter last)
+{
+	using T = typename iterator_traits<RandomIter>::value_type;
+	jan::make_heap<D>(first,last,jan::less<T>());
+}
 
-template <typename RandomIter, typename Compare	>
-inline void pop_heap(RandomIter first, RandomIter last, const Compare comp)
+/**
+ * @brief 判断[first,last)是否是一个按comp组织的D叉堆
+ * 
+ * @tparam D 
+ * @tparam RandomIter 
+ * @tparam Compare 
+ * @param first 
+ * @param last 
+ * @param comp 
+ * @return bool 
+ */
+template <size_t D = 2, typename RandomIter, typename Compare>
+bool is_heap(RandomIter first, RandomIter last, Compare comp)
 {
+	using Distance = typename iterator_traits<RandomIter>::difference_type;
+	Distance len = last - first;
+	for(Distance child = 1; child < len; ++child)
+		if(comp(*(first + (child - 1) / D), *(first + child)))
+			return false;
+	return true;
+}
 
+template <size_t D = 2, typename RandomIter>
+inline bool is_heap(RandomIter first, RandomIter last)
+{
+	using T = typename iterator_traits<RandomIter>::value_type;
+	return jan::is_heap<D>(first,last,jan::less<T>());
 }
 
 
 } // namespace jan
 
 
-#endif
\ No newline at end of file
+#endif
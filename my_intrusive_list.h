@@ -0,0 +1,292 @@
+#ifndef __MY_INTRUSIVE_LIST_H_
+#define __MY_INTRUSIVE_LIST_H_
+
+#include "my_iterator.h"
+#include "my_list.h"
+#include <cstddef>
+#include <type_traits>
+namespace jan {
+
+/**
+ * @brief 侵入式链表的挂钩, 作为成员嵌入到用户的对象中
+ *        未挂入链表时两个指针均为nullptr; 拷贝对象时不拷贝链接关系
+ *
+ */
+struct list_hook : _list_node_base {
+  list_hook() {
+    _pre = nullptr;
+    _next = nullptr;
+  }
+  list_hook(const list_hook &) : list_hook() {}
+  list_hook &operator=(const list_hook &) { return *this; }
+  bool is_linked() const { return _next != nullptr; }
+
+  /**
+   * @brief 把自己从所在的链表中摘下来, 所在链表的size不会更新，
+   *        只适用于不关心size的场合，否则应该使用intrusive_list::erase
+   *
+   */
+  void unlink() {
+    _pre->_next = _next;
+    _next->_pre = _pre;
+    _pre = nullptr;
+    _next = nullptr;
+  }
+};
+
+/**
+ * @brief 通过成员指针Hook在对象和它的挂钩之间互相转换
+ *
+ * @tparam T
+ * @tparam Hook
+ */
+template <typename T, list_hook T::*Hook> struct __hook_traits {
+  static ptrdiff_t offset() {
+    //只取成员的地址，不会访问这块未构造的内存
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+    T *p = reinterpret_cast<T *>(&buf);
+    return reinterpret_cast<char *>(&(p->*Hook)) - reinterpret_cast<char *>(p);
+  }
+  static T *to_value(_list_node_base *node) {
+    return reinterpret_cast<T *>(
+        reinterpret_cast<char *>(static_cast<list_hook *>(node)) - offset());
+  }
+  static list_hook *to_hook(T &val) { return &(val.*Hook); }
+};
+
+/**
+ * @brief 侵入式链表的迭代器, 此迭代器种类为双向迭代器
+ *
+ * @tparam T
+ * @tparam Hook
+ */
+template <typename T, list_hook T::*Hook> struct _intrusive_list_iterator {
+  using value_type = T;
+  using pointer = T *;
+  using reference = T &;
+  using size_type = size_t;
+  using iterator_category = bidirectional_iterator_tag;
+  using self = _intrusive_list_iterator<T, Hook>;
+  using difference_type = ptrdiff_t;
+  T &operator*() { return *__hook_traits<T, Hook>::to_value(_node); }
+  T *operator->() { return __hook_traits<T, Hook>::to_value(_node); }
+  bool operator==(const self &rhs) { return _node == rhs._node; }
+  bool operator!=(const self &rhs) { return _node != rhs._node; }
+  self &operator++() {
+    _node = _node->_next;
+    return *this;
+  }
+  self operator++(int) {
+    auto ret = *this;
+    ++*this;
+    return ret;
+  }
+  self &operator--() {
+    _node = _node->_pre;
+    return *this;
+  }
+  self operator--(int) {
+    auto ret = *this;
+    --*this;
+    return ret;
+  }
+  _list_node_base *_node;
+  explicit _intrusive_list_iterator(_list_node_base *node = nullptr)
+      : _node(node) {}
+};
+
+/**
+ * @brief 侵入式双向链表, 链接的是用户对象中的list_hook成员，
+ *        插入和删除都不分配内存，也不拷贝对象，对象的生命周期由用户负责
+ *        一个对象同一时刻只能挂在一个使用同一个Hook的链表中
+ *        用法: struct timer { list_hook hook; ... };
+ *              jan::intrusive_list<timer, &timer::hook> ls;
+ *
+ * @tparam T
+ * @tparam Hook
+ */
+template <typename T, list_hook T::*Hook> class intrusive_list {
+private:
+  using traits = __hook_traits<T, Hook>;
+
+public:
+  using value_type = T;
+  using iterator = _intrusive_list_iterator<T, Hook>;
+  using size_type = size_t;
+  iterator begin() const { return iterator(_header._next); }
+  iterator end() const {
+    return iterator(const_cast<_list_node_base *>(&_header));
+  }
+  bool empty() const { return _size == 0; }
+  size_type size() const { return _size; }
+  T &front() { return *begin(); }
+  T &back() { return *(--end()); }
+
+  //由对象得到指向它的迭代器, 对象必须已经在此链表中
+  static iterator iterator_to(T &val) { return iterator(traits::to_hook(val)); }
+
+  iterator insert(iterator pos, T &val);
+  void push_front(T &val) { insert(begin(), val); }
+  void push_back(T &val) { insert(end(), val); }
+
+  iterator erase(iterator pos);
+  void erase(T &val) { erase(iterator_to(val)); }
+  void pop_front() { erase(begin()); }
+  void pop_back() { auto tmp = end(); erase(--tmp); }
+  void clear();
+
+  void splice(iterator pos, intrusive_list &x);
+  void splice(iterator pos, intrusive_list &x, iterator i);
+  void splice(iterator pos, intrusive_list &x, iterator first, iterator last);
+
+protected:
+  void init_empty() {
+    _header._pre = &_header;
+    _header._next = &_header;
+    _size = 0;
+  }
+  _list_node_base _header;
+  size_type _size;
+
+public:
+  intrusive_list() { init_empty(); }
+  intrusive_list(const intrusive_list &) = delete;
+  intrusive_list &operator=(const intrusive_list &) = delete;
+
+  /**
+   * @brief 移动构造, 链表头是成员，所以要让首尾对象重新指向新的链表头
+   *
+   * @param rhs
+   */
+  intrusive_list(intrusive_list &&rhs) {
+    init_empty();
+    splice(end(), rhs);
+  }
+
+  //析构时把所有对象摘下来，对象本身不受影响
+  ~intrusive_list() { clear(); }
+};
+
+/**
+ * @brief 把val挂到pos之前, 不分配内存
+ *
+ * @tparam T
+ * @tparam Hook
+ * @param pos
+ * @param val
+ * @return intrusive_list<T, Hook>::iterator
+ */
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::insert(iterator pos, T &val) {
+  list_hook *node = traits::to_hook(val);
+  node->_pre = pos._node->_pre;
+  node->_next = pos._node;
+  pos._node->_pre->_next = node;
+  pos._node->_pre = node;
+  ++_size;
+  return iterator(node);
+}
+
+/**
+ * @brief 摘下pos指向的对象并返回其后继, 如果为空链表，则抛出一个logic_error
+ *
+ * @tparam T
+ * @tparam Hook
+ * @param pos
+ * @return intrusive_list<T, Hook>::iterator
+ */
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::erase(iterator pos) {
+  if (empty())
+    throw std::logic_error("intrusive_list is empty");
+  auto ret = pos._node->_next;
+  static_cast<list_hook *>(pos._node)->unlink();
+  --_size;
+  return iterator(ret);
+}
+
+/**
+ * @brief 摘下所有对象, 并把它们的挂钩复位
+ *
+ * @tparam T
+ * @tparam Hook
+ */
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::clear() {
+  _list_node_base *cur = _header._next;
+  while (cur != &_header) {
+    _list_node_base *next = cur->_next;
+    cur->_pre = nullptr;
+    cur->_next = nullptr;
+    cur = next;
+  }
+  init_empty();
+}
+
+/**
+ * @brief 将x拼接在pos之前
+ *
+ * @tparam T
+ * @tparam Hook
+ * @param pos
+ * @param x
+ */
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::splice(iterator pos, intrusive_list &x) {
+  if (x.empty() || &x == this)
+    return;
+  __list_transfer(pos._node, x._header._next, &x._header);
+  _size += x._size;
+  x._size = 0;
+}
+
+/**
+ * @brief 将x中i指向的对象拼接在pos之前
+ *
+ * @tparam T
+ * @tparam Hook
+ * @param pos
+ * @param x
+ * @param i
+ */
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::splice(iterator pos, intrusive_list &x,
+                                     iterator i) {
+  auto j = i;
+  ++j;
+  if (pos == i || pos == j)
+    return;
+  __list_transfer(pos._node, i._node, j._node);
+  --x._size;
+  ++_size;
+}
+
+/**
+ * @brief 将x中[first,last)的对象拼接在pos之前, pos不能位于[first,last)间
+ *        来自另一个链表时需要数一遍区间长度
+ *
+ * @tparam T
+ * @tparam Hook
+ * @param pos
+ * @param x
+ * @param first
+ * @param last
+ */
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::splice(iterator pos, intrusive_list &x,
+                                     iterator first, iterator last) {
+  if (first == last)
+    return;
+  if (&x != this) {
+    size_type n = jan::distance(first, last);
+    x._size -= n;
+    _size += n;
+  }
+  __list_transfer(pos._node, first._node, last._node);
+}
+
+} // namespace jan
+
+#endif
@@ -3,31 +3,58 @@
 
 #include "my_algorithm.h"
 #include "my_allocator.h"
+#include "my_functional.h"
 #include "my_iterator.h"
 #include <cstddef>
 #include <initializer_list>
 #include <stdexcept>
 namespace jan {
 
+/**
+ * @brief 双向链表节点的链接部分, 所有的拼接操作只与它打交道
+ *
+ */
+struct _list_node_base {
+  _list_node_base *_pre;
+  _list_node_base *_next;
+};
+
 /**
  * @brief 双向链表的节点
  *
  * @tparam T
  */
-template <typename T> struct _list_node {
-  using self = _list_node<T>;
+template <typename T> struct _list_node : _list_node_base {
   T _data;
-  self *_pre;
-  self *_next;
   template <typename... Args>
-  explicit _list_node(Args &&...args, self *pre = nullptr, self *next = nullptr)
-      : _data(10), _pre(pre), _next(next) {}
-
-  explicit _list_node(const T &val = T(), self *pre = nullptr,
-                      self *next = nullptr)
-      : _data(val), _pre(pre), _next(next) {}
+  explicit _list_node(Args &&...args) : _data(std::forward<Args>(args)...) {
+    _pre = nullptr;
+    _next = nullptr;
+  }
 };
 
+/**
+ * @brief 将[first,last)的节点移动到pos前, 可以是一个链表中，也可是不同的链表中,
+ *        但是pos不能位于[first,last)间
+ *        list和intrusive_list的splice都建立在它之上
+ *
+ * @param pos
+ * @param first
+ * @param last
+ */
+inline void __list_transfer(_list_node_base *pos, _list_node_base *first,
+                            _list_node_base *last) {
+  if (last == pos || first == last)
+    return;
+  last->_pre->_next = pos;
+  first->_pre->_next = last;
+  pos->_pre->_next = first;
+  _list_node_base *tmp = pos->_pre;
+  pos->_pre = last->_pre;
+  last->_pre = first->_pre;
+  first->_pre = tmp;
+}
+
 /**
  * @brief 双向链表的迭代器, 此迭代器种类为双向迭代器,支持operator->
  *
@@ -36,14 +63,14 @@ template <typename T> struct _list_node {
 template <typename T> struct _list_iterator {
   using value_type = T;
   using pointer = T *;
-  using receference = T &;
+  using reference = T &;
   using size_type = size_t;
   using iterator_category = bidirectional_iterator_tag;
   using self = _list_iterator<T>;
   using node_type = _list_node<T>;
   using difference_type = ptrdiff_t;
-  T &operator*() { return _node->_data; }
-  T *operator->() { return &*_node; }
+  T &operator*() { return static_cast<node_type *>(_node)->_data; }
+  T *operator->() { return &static_cast<node_type *>(_node)->_data; }
   bool operator==(const self &rhs) { return _node == rhs._node; }
   bool operator!=(const self &rhs) { return _node != rhs._node; }
   self &operator++() {
@@ -64,11 +91,71 @@ template <typename T> struct _list_iterator {
     --*this;
     return ret;
   }
-  node_type *_node;
-  explicit _list_iterator(node_type *node = nullptr) : _node(node) {}
+  _list_node_base *_node;
+  explicit _list_iterator(_list_node_base *node = nullptr) : _node(node) {}
   _list_iterator(const self &iteraotr) : _list_iterator(iteraotr._node) {}
 };
 
+/**
+ * @brief list节点的内存池, 同一种节点的所有list共用一个
+ *        每次向Alloc申请一整块能放下多个节点的内存(chunk)，切分后挂到空闲链表上,
+ *        chunk的节点数从16开始翻倍增长, 最多4096个
+ *        空闲链表借用节点自己的_next串起来，所以一整条链表可以O(1)地还回池中
+ *        与二级配置器一样，申请到的chunk不会还给系统，也不是线程安全的
+ *
+ * @tparam Node
+ * @tparam Alloc
+ */
+template <typename Node, typename Alloc> class _list_node_pool {
+private:
+  using chunk_allocator = alloc_adapter<Node, Alloc>;
+  enum { _MIN_CHUNK_NODES = 16, _MAX_CHUNK_NODES = 4096 };
+  static Node *free_list;
+  static size_t chunk_nodes;
+  static void refill();
+
+public:
+  static Node *allocate() {
+    if (free_list == nullptr)
+      refill();
+    Node *ret = free_list;
+    free_list = static_cast<Node *>(ret->_next);
+    return ret;
+  }
+  static void deallocate(Node *p) {
+    p->_next = free_list;
+    free_list = p;
+  }
+  //归还从first开始沿_next一直到last(包含last)的一串节点
+  static void deallocate(Node *first, Node *last) {
+    last->_next = free_list;
+    free_list = first;
+  }
+};
+
+template <typename Node, typename Alloc>
+Node *_list_node_pool<Node, Alloc>::free_list = nullptr;
+
+template <typename Node, typename Alloc>
+size_t _list_node_pool<Node, Alloc>::chunk_nodes = _MIN_CHUNK_NODES;
+
+/**
+ * @brief 空闲链表用完时申请一个新的chunk, 按节点切分后串成空闲链表
+ *
+ * @tparam Node
+ * @tparam Alloc
+ */
+template <typename Node, typename Alloc>
+void _list_node_pool<Node, Alloc>::refill() {
+  Node *chunk = chunk_allocator::allocate(chunk_nodes);
+  for (size_t i = 0; i + 1 < chunk_nodes; ++i)
+    chunk[i]._next = chunk + i + 1;
+  chunk[chunk_nodes - 1]._next = nullptr;
+  free_list = chunk;
+  if (chunk_nodes < _MAX_CHUNK_NODES)
+    chunk_nodes *= 2;
+}
+
 /**
  * @brief 双向链表容器, O(1)的插入和删除，基于双向环状链表组织
  *
@@ -82,10 +169,10 @@ private:
 public:
   using iterator = _list_iterator<T>;
   using size_type = size_t;
-  iterator begin() const { return iterator(_base_node->_next); }
-  iterator end() const { return iterator(_base_node); }
-  bool empty() const { return _base_node->_next == _base_node; }
-  size_type size() const { return distance(begin(), end()); }
+  iterator begin() const { return iterator(_header._next); }
+  iterator end() const { return iterator(const_cast<_list_node_base *>(&_header)); }
+  bool empty() const { return _size == 0; }
+  size_type size() const { return _size; }
   T &front() { return *begin(); }
   T &back() { return *(--end()); }
 
@@ -101,61 +188,52 @@ public:
   void remove(const T & val);
 
   void unique();
-  void transfer(iterator pos, iterator first, iterator last);
   void splice(iterator pos, list & x);
-  void splice(iterator pos, list &, iterator i);
+  void splice(iterator pos, list & x, iterator i);
   void splice(iterator pos, list & x, iterator first, iterator last);
   void reverse();
-  void merge(list<T,Alloc> & ls);
+  void merge(list<T,Alloc> & ls) { merge(ls, jan::less<T>()); }
+  template <typename Compare> void merge(list<T,Alloc> & ls, Compare comp);
+  void sort() { sort(jan::less<T>()); }
+  template <typename Compare> void sort(Compare comp);
 protected:
-  using node_alloc = alloc_adapter<node_type, Alloc>;
+  void transfer(iterator pos, iterator first, iterator last);
+  using node_pool = _list_node_pool<node_type, Alloc>;
   //传回一个节点大小内存空间
-  node_type *get_node() { return node_alloc::allocate(); }
-  void put_node(node_type *p) { node_alloc::deallocate(p,0); }
+  node_type *get_node() { return node_pool::allocate(); }
+  void put_node(node_type *p) { node_pool::deallocate(p); }
   template <typename... Args> node_type *creat_node(Args &&...args) {
     auto ret = get_node();
-    construct(ret, std::forward<Args>(args)...);
+    jan::construct(ret, std::forward<Args>(args)...);
     return ret;
   }
   node_type *creat_node(const T &val) {
     auto ret = get_node();
-    construct(ret, val);
+    jan::construct(ret, val);
     return ret;
   }
+  static T &value(_list_node_base *p) { return static_cast<node_type *>(p)->_data; }
+  template <typename Compare>
+  static void merge_ring(_list_node_base *head1, _list_node_base *head2, Compare comp);
   void destroy_node(node_type *p) {
     if(p == nullptr)
       return;
-    destroy(&(p->_data));
+    jan::destroy(&(p->_data));
     put_node(p);
   }
+  void init_empty() {
+    _header._next = &_header;
+    _header._pre = &_header;
+    _size = 0;
+  }
 
-  //此节点为基点，也是尾后节点
-  node_type *_base_node;
+  //链表头，也是尾后节点, 只有两个指针，不含T, 空链表不需要分配任何内存
+  _list_node_base _header;
+  //元素个数, 所有改变链接的操作都负责维护它
+  size_type _size;
   
-  //回收所有的数据节点，也就是除了_base_node的所有节点，
-  //并把_base_node 下的pre next 滞空
-  void dealloc_all_data_node()
-  {
-    //for move construct
-    if (_base_node == nullptr)
-      return;
-    auto cur = begin();
-    while (cur != end())
-    {
-      auto tmp = cur;
-      ++tmp;
-      destroy_node(cur._node);
-      cur = tmp;
-    }
-    _base_node->_next = nullptr;
-    _base_node->_pre = nullptr;
-  }
 public:
-  list() {
-    _base_node = creat_node(T{});
-    _base_node->_next = _base_node;
-    _base_node->_pre = _base_node;
-  }
+  list() { init_empty(); }
 
   list(const std::initializer_list<T> & ls) : list()
   {
@@ -163,64 +241,171 @@ public:
       push_back(*it);
   }
 
-  explicit list(size_type n, const T & val = T{})
+  explicit list(size_type n, const T & val = T{}) : list()
   {
     while(n--)
       push_back(val);
   }
 
-  list(const list<T,Alloc> & rhs)
+  list(const list<T,Alloc> & rhs) : list()
   {
     for(const auto & val : rhs)
       push_back(val);
   }
 
   /**
-   * @brief 移动构造，将被移动的list 的 _base_node 置空，确保能被正常析构
+   * @brief 移动构造，链表头是成员，所以把rhs的整串节点拼接过来，rhs变为空链表
    * 
    * @param rhs 
    */
-  list(list<T,Alloc> && rhs)
+  list(list<T,Alloc> && rhs) : list()
   {
-    _base_node = rhs._base_node;
-    rhs._base_node = nullptr;
+    splice(end(), rhs);
+  }
+
+  list<T,Alloc> & operator=(const list<T,Alloc> & rhs)
+  {
+    if (this != &rhs)
+    {
+      clear();
+      for(const auto & val : rhs)
+        push_back(val);
+    }
+    return *this;
+  }
+
+  list<T,Alloc> & operator=(list<T,Alloc> && rhs)
+  {
+    if (this != &rhs)
+    {
+      clear();
+      splice(end(), rhs);
+    }
+    return *this;
   }
 
   ~list()
   {
-    dealloc_all_data_node();
-    //if _base_node = nullptr it's also no problem
-    destroy_node(_base_node);
+    clear();
   }
 };
 
 
 /**
- * @brief 将ls合并到*this上，请确保两个list均已经排序, 否则这是一个未定义的行为
+ * @brief 把以head2为头的有序环状链表合并到以head1为头的有序环状链表中, head2变为空
+ *        每次把head2中一整段小于*first1的节点一起transfer过去，而不是一个一个地移动,
+ *        相等的元素head1中的排在前面，所以是稳定的
  * 
  * @tparam T 
  * @tparam Alloc 
- * @param ls 
+ * @tparam Compare 
+ * @param head1 
+ * @param head2 
+ * @param comp 
  */
 template <typename T, typename Alloc>
-void list<T,Alloc>::merge(list<T, Alloc> &ls)
+template <typename Compare>
+void list<T,Alloc>::merge_ring(_list_node_base *head1, _list_node_base *head2, Compare comp)
 {
-  auto first1 = begin(), last1 = end(),
-       first2 = ls.begin(), last2 = ls.end();
-  while (first1 != last1 && first2 != last2)
+  _list_node_base *first1 = head1->_next, *first2 = head2->_next;
+  while (first1 != head1 && first2 != head2)
   {
-    if(*first2 < *first1)
+    if (comp(value(first2), value(first1)))
     {
-      auto next = first2;
-      transfer(first1, first2, ++next);
+      _list_node_base *next = first2->_next;
+      while (next != head2 && comp(value(next), value(first1)))
+        next = next->_next;
+      __list_transfer(first1, first2, next);
       first2 = next;
     }
     else
-      ++first1;
+      first1 = first1->_next;
   }
   //还有元素，是ls中比*this的所有元素都大的元素
-  if(first2 != last2)
-    transfer(last1, first2, last2);
+  if (first2 != head2)
+    __list_transfer(head1, first2, head2);
+}
+
+/**
+ * @brief 将ls合并到*this上，请确保两个list均已经按comp排序, 否则这是一个未定义的行为
+ * 
+ * @tparam T 
+ * @tparam Alloc 
+ * @tparam Compare 
+ * @param ls 
+ * @param comp 
+ */
+template <typename T, typename Alloc>
+template <typename Compare>
+void list<T,Alloc>::merge(list<T, Alloc> &ls, Compare comp)
+{
+  if (&ls == this)
+    return;
+  const size_type total = _size + ls._size;
+  try {
+    merge_ring(&_header, &ls._header, comp);
+  } catch (...) {
+    //comp抛出异常时已有部分节点移入*this, 重新数ls剩下的节点以保持两边的_size正确
+    size_type n = 0;
+    for (_list_node_base *cur = ls._header._next; cur != &ls._header; cur = cur->_next)
+      ++n;
+    ls._size = n;
+    _size = total - n;
+    throw;
+  }
+  _size = total;
+  ls._size = 0;
+}
+
+/**
+ * @brief 稳定的O(nlogn)排序, 只改变节点的链接，不分配内存也不拷贝元素
+ *        counter[i]中保存长度为2^i的有序段，每取下一个节点就像二进制加1一样向上合并
+ *        carry和counter都只是栈上的链表头
+ * 
+ * @tparam T 
+ * @tparam Alloc 
+ * @tparam Compare 
+ * @param comp 
+ */
+template <typename T, typename Alloc>
+template <typename Compare>
+void list<T,Alloc>::sort(Compare comp)
+{
+  //if size = 0 || size = 1
+  if(_header._next == &_header || _header._next->_next == &_header)
+    return;
+  _list_node_base carry;
+  _list_node_base counter[64];
+  carry._pre = carry._next = &carry;
+  for (auto & c : counter)
+    c._pre = c._next = &c;
+  int fill = 0;
+  try {
+    while (_header._next != &_header)
+    {
+      __list_transfer(&carry, _header._next, _header._next->_next);
+      int i = 0;
+      while (i < fill && counter[i]._next != &counter[i])
+      {
+        //counter[i]中的元素比carry中的先出现, 作为head1保证稳定
+        merge_ring(&counter[i], &carry, comp);
+        __list_transfer(&carry, counter[i]._next, &counter[i]);
+        ++i;
+      }
+      __list_transfer(&counter[i], carry._next, &carry);
+      if (i == fill)
+        ++fill;
+    }
+    for (int i = 1; i < fill; ++i)
+      merge_ring(&counter[i], &counter[i - 1], comp);
+  } catch (...) {
+    //comp抛出异常时把所有节点还给*this, 不丢失元素
+    __list_transfer(&_header, carry._next, &carry);
+    for (int i = 0; i < fill; ++i)
+      __list_transfer(&_header, counter[i]._next, &counter[i]);
+    throw;
+  }
+  __list_transfer(&_header, counter[fill - 1]._next, &counter[fill - 1]);
 }
 
 /**
@@ -233,7 +418,7 @@ template <typename T, typename Alloc>
 void list<T,Alloc>::reverse()
 {
   //if size = 0 || size = 1
-  if(_base_node->_next == _base_node || _base_node->_next->_next == _base_node)
+  if(_header._next == &_header || _header._next->_next == &_header)
     return;
   //对于每个节点，均使用swap交换pre and next，即可达到实现翻转的效果
   auto cur = begin();
@@ -241,45 +426,56 @@ void list<T,Alloc>::reverse()
   {
     auto tmp = cur;
     ++tmp;
-    swap(cur._node->_pre,cur._node->_next);
+    jan::swap(cur._node->_pre,cur._node->_next);
     cur = tmp;
   }
-  swap(cur._node->_pre,cur._node->_next); 
+  jan::swap(cur._node->_pre,cur._node->_next); 
 }
 
 /**
- * @brief 将i指向元素拼接在pos之前
+ * @brief 将x中i指向元素拼接在pos之前
  * 
  * @tparam T 
  * @tparam Alloc 
  * @param pos 
+ * @param x 
  * @param i 
  */
 template <typename T, typename Alloc>
-void list<T,Alloc>::splice(iterator pos, list &, iterator i)
+void list<T,Alloc>::splice(iterator pos, list & x, iterator i)
 {
   auto j = i;
   ++j;
   if(pos == i || pos == j) //自己或者本来就在前面
     return;
   transfer(pos, i, j);
+  --x._size;
+  ++_size;
 }
 
 
 /**
- * @brief 将[first,last)内的所有元素拼接在pos之前
- *        可以是一个list中，也可是不同的list中，但是pos不能位于[first.last)间
+ * @brief 将x中[first,last)内的所有元素拼接在pos之前
+ *        x可以就是*this，也可是不同的list，但是pos不能位于[first.last)间
+ *        来自不同的list时要数一遍区间长度来维护size, 所以是O(n)的
  * @tparam T 
  * @tparam Alloc 
  * @param pos 
+ * @param x 
  * @param first 
  * @param last 
  */
 template <typename T, typename Alloc>
-void list<T,Alloc>::splice(iterator pos, list &, iterator first, iterator last)
+void list<T,Alloc>::splice(iterator pos, list & x, iterator first, iterator last)
 {
   if(first == last)
     return;
+  if (&x != this)
+  {
+    size_type n = jan::distance(first, last);
+    x._size -= n;
+    _size += n;
+  }
   transfer(pos, first, last);
 }
 
@@ -294,13 +490,16 @@ void list<T,Alloc>::splice(iterator pos, list &, iterator first, iterator last)
 template <typename T, typename Alloc>
 void list<T,Alloc>::splice(iterator pos, list<T, Alloc> &x)
 {
-  if (x.empty())
+  if (x.empty() || &x == this)
     return;
   transfer(pos, x.begin(), x.end());
+  _size += x._size;
+  x._size = 0;
 }
 /**
  * @brief 将区间[first,last) 的节点移动到pos前, 
  *        可以是一个list中，也可是不同的list中，但是pos不能位于[first.last)间
+ *        它不知道节点来自哪个list，不会维护size, 所以只供splice和merge内部使用
  * 
  * @tparam T 
  * @tparam Alloc 
@@ -311,15 +510,7 @@ void list<T,Alloc>::splice(iterator pos, list<T, Alloc> &x)
 template <typename T, typename Alloc>
 void list<T,Alloc>::transfer(iterator pos, iterator first, iterator last)
 {
-  if(last == pos)
-    return;
-  last._node->_pre->_next = pos._node;
-  first._node->_pre->_next = last._node;
-  pos._node->_pre->_next = first._node;
-  auto tmp = pos._node->_pre;
-  pos._node->_pre = last._node->_pre;
-  last._node->_pre = first._node->_pre;
-  first._node->_pre = tmp;
+  __list_transfer(pos._node, first._node, last._node);
 }
 
 /**
@@ -338,6 +529,8 @@ void list<T,Alloc>::unique()
   {
     auto next = first;
     ++next;
+    if (next == last)
+      break;
     if(*first == *next)
       erase(next);
     else
@@ -368,7 +561,8 @@ void list<T,Alloc>::remove(const T &val)
 }
   
 /**
- * @brief 将整个链表清空
+ * @brief 将整个链表清空, 元素析构之后整条链一次性还给节点池,
+ *        如果T的析构函数是trivial的，就不需要遍历链表
  * 
  * @tparam T 
  * @tparam Alloc 
@@ -376,15 +570,12 @@ void list<T,Alloc>::remove(const T &val)
 template <typename T, typename Alloc>
 void list<T,Alloc>::clear()
 {
-  auto current_node = _base_node->_next; //begin()._node
-  while (current_node != _base_node)
-  {
-    auto tmp = current_node->_next;
-    destroy_node(current_node);
-    current_node = tmp;
-  }
-  _base_node->_next = _base_node;
-  _base_node->_pre = _base_node;
+  if (empty())
+    return;
+  jan::destroy(begin(), end());
+  node_pool::deallocate(static_cast<node_type *>(_header._next),
+                        static_cast<node_type *>(_header._pre));
+  init_empty();
 }
 
 
@@ -407,6 +598,7 @@ list<T, Alloc>::insert(iterator pos, const T &val)
   node->_next = pos._node;
   pos._node->_pre->_next = node;
   pos._node->_pre = node;
+  ++_size;
   return iterator(node);
 }
 
@@ -429,7 +621,8 @@ list<T,Alloc>::erase(iterator pos)
   pos._node->_next->_pre = pos._node->_pre;
   pos._node->_next = nullptr;
   pos._node->_pre = nullptr;
-  destroy_node(pos._node);
+  destroy_node(static_cast<node_type *>(pos._node));
+  --_size;
   return iterator(ret);
 }
 
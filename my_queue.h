@@ -0,0 +1,656 @@
+#ifndef __MY_QUEUE_H_
+#define __MY_QUEUE_H_
+
+#include "my_functional.h"
+#include "my_heap.h"
+#include "my_vector.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+namespace jan {
+
+/**
+ * @brief 优先队列, 底层容器上维护一个堆, 默认是大根堆
+ *        容器需要提供随机访问迭代器以及front, emplace_back, pop_back,
+ *        erase(first,last), size, empty
+ *
+ * @tparam T
+ * @tparam Container
+ * @tparam Compare
+ */
+template <typename T, typename Container = jan::vector<T>,
+          typename Compare = jan::less<T>>
+class priority_queue {
+public:
+  using value_type = T;
+  using container_type = Container;
+  using value_compare = Compare;
+  using size_type = size_t;
+  using reference = T &;
+
+  priority_queue() : c(), comp() {}
+  explicit priority_queue(const Compare &cmp) : c(), comp(cmp) {}
+  template <typename InputIter>
+  priority_queue(InputIter first, InputIter last, const Compare &cmp = Compare())
+      : c(), comp(cmp) {
+    for (; first != last; ++first)
+      c.emplace_back(*first);
+    jan::make_heap(c.begin(), c.end(), comp);
+  }
+
+  bool empty() const { return c.empty(); }
+  size_type size() const { return c.size(); }
+  reference top() { return c.front(); }
+
+  void push(const T &val) {
+    c.emplace_back(val);
+    jan::push_heap(c.begin(), c.end(), comp);
+  }
+  void push(T &&val) {
+    c.emplace_back(std::move(val));
+    jan::push_heap(c.begin(), c.end(), comp);
+  }
+  template <typename... Args> void emplace(Args &&... args) {
+    c.emplace_back(std::forward<Args>(args)...);
+    jan::push_heap(c.begin(), c.end(), comp);
+  }
+  void pop() {
+    jan::pop_heap(c.begin(), c.end(), comp);
+    c.pop_back();
+  }
+
+  template <typename InputIter> void push_range(InputIter first, InputIter last);
+  template <typename OutputIter> OutputIter pop_n(OutputIter res, size_type k);
+
+protected:
+  Container c;
+  Compare comp;
+};
+
+/**
+ * @brief 一次放入[first,last)中的k个元素, 队列原有n个元素
+ *        逐个上溯的代价约为k*log2(n+k), 重新建堆的代价约为2(n+k),
+ *        前者更大时改为对整个容器make_heap
+ *        放入元素时抛出异常则撤销本次放入的所有元素
+ *
+ * @tparam T
+ * @tparam Container
+ * @tparam Compare
+ * @tparam InputIter
+ * @param first
+ * @param last
+ */
+template <typename T, typename Container, typename Compare>
+template <typename InputIter>
+void priority_queue<T, Container, Compare>::push_range(InputIter first,
+                                                       InputIter last) {
+  const size_type old_size = c.size();
+  try {
+    for (; first != last; ++first)
+      c.emplace_back(*first);
+  } catch (...) {
+    c.erase(c.begin() + old_size, c.end());
+    throw;
+  }
+  const size_type n = c.size();
+  const size_type k = n - old_size;
+  size_type log_n = 0;
+  for (size_type m = n; m > 1; m >>= 1)
+    ++log_n;
+  if (k * log_n > 2 * n)
+    jan::make_heap(c.begin(), c.end(), comp);
+  else
+    for (auto it = c.begin() + old_size; it != c.end();)
+      jan::push_heap(c.begin(), ++it, comp);
+}
+
+/**
+ * @brief 按优先级从高到低取出前k个元素(不足k个时全部取出)写到res, 返回写完后的res
+ *        依次pop_heap后这k个元素倒序排在容器尾部, 倒着移出去后只需要一次erase
+ *
+ * @tparam T
+ * @tparam Container
+ * @tparam Compare
+ * @tparam OutputIter
+ * @param res
+ * @param k
+ * @return OutputIter
+ */
+template <typename T, typename Container, typename Compare>
+template <typename OutputIter>
+OutputIter priority_queue<T, Container, Compare>::pop_n(OutputIter res,
+                                                        size_type k) {
+  if (k > c.size())
+    k = c.size();
+  auto last = c.end();
+  for (size_type i = 0; i < k; ++i, --last)
+    jan::pop_heap(c.begin(), last, comp);
+  for (auto it = c.end(); it != last; ++res)
+    *res = std::move(*--it);
+  c.erase(last, c.end());
+  return res;
+}
+
+/**
+ * @brief 可寻址的D叉堆, push返回一个句柄, 之后可以用句柄修改或删除这个元素
+ *        heap中存放(值, 句柄), pos[句柄]记录它在heap中的下标,
+ *        调整堆时通过__push_heap/__adjust_heap的notify回调更新pos
+ *        被删除元素的句柄会被之后的push复用; 要求comp不抛出异常
+ *
+ * @tparam T
+ * @tparam D 堆的叉数
+ * @tparam Compare
+ */
+template <typename T, size_t D = 4, typename Compare = jan::less<T>>
+class indexed_heap {
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using handle = size_t;
+
+  indexed_heap() : comp() {}
+  explicit indexed_heap(const Compare &cmp) : comp(cmp) {}
+
+  bool empty() const { return heap.empty(); }
+  size_type size() const { return heap.size(); }
+  const T &top() const { return heap.front().val; }
+  handle top_handle() const { return heap.front().h; }
+  bool contains(handle h) const { return h < pos.size() && pos[h] != npos; }
+  const T &value(handle h) const { return heap[pos[h]].val; }
+
+  handle push(const T &val) { return emplace(val); }
+  template <typename... Args> handle emplace(Args &&... args);
+  void pop() { erase(top_handle()); }
+  void erase(handle h);
+  void update(handle h, const T &val);
+  void decrease_key(handle h, const T &val);
+
+protected:
+  static const size_type npos = static_cast<size_type>(-1);
+  struct node {
+    T val;
+    handle h;
+    template <typename... Args>
+    node(handle hd, Args &&... args) : val(std::forward<Args>(args)...), h(hd) {}
+  };
+  struct node_compare {
+    Compare comp;
+    bool operator()(const node &a, const node &b) const { return comp(a.val, b.val); }
+  };
+  //元素落到下标idx时更新它的句柄的位置
+  struct notify_pos {
+    size_type *pos;
+    void operator()(node &n, ptrdiff_t idx) const { pos[n.h] = idx; }
+  };
+  node_compare node_comp() const { return node_compare{comp}; }
+  notify_pos notifier() { return notify_pos{pos.begin()}; }
+  void sift(size_type idx, node val);
+
+  jan::vector<node> heap;
+  jan::vector<size_type> pos;
+  jan::vector<handle> free_handles;
+  Compare comp;
+};
+
+template <typename T, size_t D, typename Compare>
+const typename indexed_heap<T, D, Compare>::size_type
+    indexed_heap<T, D, Compare>::npos;
+
+/**
+ * @brief 把val放进下标idx处的空洞, 比父节点优先就上溯，否则下沉
+ *
+ * @tparam T
+ * @tparam D
+ * @tparam Compare
+ * @param idx
+ * @param val
+ */
+template <typename T, size_t D, typename Compare>
+void indexed_heap<T, D, Compare>::sift(size_type idx, node val) {
+  const ptrdiff_t hold = static_cast<ptrdiff_t>(idx);
+  if (idx > 0 && node_comp()(heap[(idx - 1) / D], val))
+    jan::__push_heap<D>(heap.begin(), hold, ptrdiff_t(0), std::move(val),
+                        node_comp(), notifier());
+  else
+    jan::__adjust_heap<D>(heap.begin(), hold,
+                          static_cast<ptrdiff_t>(heap.size()), std::move(val),
+                          node_comp(), notifier());
+}
+
+/**
+ * @brief 构造一个新元素放入堆中, 返回它的句柄
+ *
+ * @tparam T
+ * @tparam D
+ * @tparam Compare
+ * @tparam Args
+ * @param args
+ * @return indexed_heap<T, D, Compare>::handle
+ */
+template <typename T, size_t D, typename Compare>
+template <typename... Args>
+typename indexed_heap<T, D, Compare>::handle
+indexed_heap<T, D, Compare>::emplace(Args &&... args) {
+  const bool reuse = !free_handles.empty();
+  if (!reuse)
+    pos.push_back(npos);
+  const handle h = reuse ? free_handles.back() : pos.size() - 1;
+  heap.emplace_back(h, std::forward<Args>(args)...);
+  if (reuse)
+    free_handles.pop_back();
+  const ptrdiff_t last = static_cast<ptrdiff_t>(heap.size()) - 1;
+  jan::__push_heap<D>(heap.begin(), last, ptrdiff_t(0), node(std::move(heap.back())),
+                      node_comp(), notifier());
+  return h;
+}
+
+/**
+ * @brief 删除句柄h对应的元素, 用最后一个元素填补它的位置后再调整
+ *        h不在堆中时抛出一个invalid_argument
+ *
+ * @tparam T
+ * @tparam D
+ * @tparam Compare
+ * @param h
+ */
+template <typename T, size_t D, typename Compare>
+void indexed_heap<T, D, Compare>::erase(handle h) {
+  if (!contains(h))
+    throw std::invalid_argument("handle is not in the heap");
+  const size_type idx = pos[h];
+  const size_type last = heap.size() - 1;
+  free_handles.push_back(h);
+  pos[h] = npos;
+  if (idx == last) {
+    heap.pop_back();
+    return;
+  }
+  node tmp(std::move(heap.back()));
+  heap.pop_back();
+  sift(idx, std::move(tmp));
+}
+
+/**
+ * @brief 把句柄h对应的元素改为val, 根据新值上溯或下沉
+ *
+ * @tparam T
+ * @tparam D
+ * @tparam Compare
+ * @param h
+ * @param val
+ */
+template <typename T, size_t D, typename Compare>
+void indexed_heap<T, D, Compare>::update(handle h, const T &val) {
+  if (!contains(h))
+    throw std::invalid_argument("handle is not in the heap");
+  sift(pos[h], node(h, val));
+}
+
+/**
+ * @brief 提高句柄h对应元素的优先级, 只需要上溯
+ *        对于用jan::greater组织的小根堆(如Dijkstra), 就是把key减小为val
+ *        val的优先级比原值低时抛出一个invalid_argument
+ *
+ * @tparam T
+ * @tparam D
+ * @tparam Compare
+ * @param h
+ * @param val
+ */
+template <typename T, size_t D, typename Compare>
+void indexed_heap<T, D, Compare>::decrease_key(handle h, const T &val) {
+  if (!contains(h))
+    throw std::invalid_argument("handle is not in the heap");
+  const size_type idx = pos[h];
+  if (comp(val, heap[idx].val))
+    throw std::invalid_argument("new key has a lower priority");
+  jan::__push_heap<D>(heap.begin(), static_cast<ptrdiff_t>(idx), ptrdiff_t(0),
+                      node(h, val), node_comp(), notifier());
+}
+
+/**
+ * @brief 单遍输入上的流式top-k: 只保留按comp最大的k个元素(默认jan::less即最大的k个),
+ *        内部是一个大小不超过k的小根堆, 堆顶是当前第k大的元素, 也就是进入结果的门槛
+ *        放入一个元素: 未满时push_heap; 满了之后只有比门槛大的元素才替换堆顶并下沉,
+ *        大部分元素只需要一次比较, 总代价约为n + m*log(k), m为替换的次数
+ *
+ * @tparam T
+ * @tparam Compare
+ */
+template <typename T, typename Compare = jan::less<T>> class top_k {
+public:
+  using value_type = T;
+  using size_type = size_t;
+
+  explicit top_k(size_type k, const Compare &cmp = Compare()) : _k(k), comp{cmp} {}
+
+  bool empty() const { return heap.empty(); }
+  size_type size() const { return heap.size(); }
+  size_type capacity() const { return _k; }
+  //已经放满k个时, 比它大的元素才能进入结果
+  const T &threshold() const { return heap.front(); }
+
+  void push(const T &val) {
+    if (heap.size() < _k) {
+      heap.emplace_back(val);
+      jan::push_heap(heap.begin(), heap.end(), comp);
+    } else if (_k != 0 && comp.comp(heap.front(), val))
+      jan::__adjust_heap<2>(heap.begin(), ptrdiff_t(0),
+                            static_cast<ptrdiff_t>(heap.size()), T(val), comp);
+  }
+  template <typename InputIter> void push_range(InputIter first, InputIter last) {
+    for (; first != last; ++first)
+      push(*first);
+  }
+  template <typename OutputIter> OutputIter copy_sorted(OutputIter res) const;
+  void clear() { heap.clear(); }
+
+protected:
+  //把comp反过来, 堆顶就是保留下来的元素中最小的一个
+  struct reverse_compare {
+    Compare comp;
+    bool operator()(const T &a, const T &b) const { return comp(b, a); }
+  };
+
+  size_type _k;
+  reverse_compare comp;
+  jan::vector<T> heap;
+};
+
+/**
+ * @brief 按从大到小的顺序把保留下来的元素写到res, 返回写完后的res, 不改变累加器
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam OutputIter
+ * @param res
+ * @return OutputIter
+ */
+template <typename T, typename Compare>
+template <typename OutputIter>
+OutputIter top_k<T, Compare>::copy_sorted(OutputIter res) const {
+  jan::vector<T> tmp;
+  for (auto it = heap.begin(); it != heap.end(); ++it)
+    tmp.emplace_back(*it);
+  //按反过来的comp排序, 结果就是从大到小
+  jan::sort_heap(tmp.begin(), tmp.end(), comp);
+  for (auto it = tmp.begin(); it != tmp.end(); ++it, ++res)
+    *res = *it;
+  return res;
+}
+
+//比较足够便宜, 败者树每层比较两次也比一次比较加上更长的依赖链快
+template <typename T, typename Compare> struct __cheap_compare : std::false_type {};
+template <typename T>
+struct __cheap_compare<T, jan::less<T>> : std::is_arithmetic<T> {};
+template <typename T>
+struct __cheap_compare<T, jan::greater<T>> : std::is_arithmetic<T> {};
+
+/**
+ * @brief 败者树, 从k个有序的源中每次取出按comp最小的元素
+ *        内部结点1..k-1记录在这个结点的比赛中输掉的源, 结点0是总的胜者, 第i个源是叶子i + k
+ *        取走胜者后它的源前进一步, 只需沿叶子到根的路径和每层的败者比赛一次,
+ *        不像堆那样每层要先比较两个孩子; 相等的元素编号小的源获胜, 所以归并是稳定的
+ *        一次比赛只调用一次comp; 只有算术类型配jan::less/jan::greater时调用两次,
+ *        两次比较互不依赖, 在这种便宜的比较上比交换参数的一次比较更快
+ *        结点里直接存败者当前元素的指针, 每层读取指针不依赖上一层的结果, 并先预取它指向的元素,
+ *        比赛结果只用来选择交换与否, 不产生分支, 避免了随机数据上每层一次的分支预测失败
+ *
+ * @tparam Iter 源的迭代器, 至少是前向迭代器
+ * @tparam Compare
+ */
+template <typename Iter, typename Compare> class loser_tree {
+public:
+  using value_type = typename iterator_traits<Iter>::value_type;
+  using size_type = size_t;
+
+  explicit loser_tree(const Compare &cmp = Compare()) : comp(cmp) {}
+
+  //加入一个源, 所有源加入之后调用build
+  void add_source(Iter first, Iter last) { src.push_back(source{first, last}); }
+  void build();
+
+  size_type sources() const { return src.size(); }
+  bool empty() const { return src.empty() || (_src[0] & done) != 0; }
+  //当前最小的元素和它所在的源
+  const value_type &top() const { return *_key[0]; }
+  size_type winner() const { return _src[0] & ~done; }
+  void pop() {
+    size_type w = _src[0];
+    const value_type *key = _key[0];
+    source &s = src[w];
+    if (++s.cur != s.last)
+      key = &*s.cur;
+    else
+      w |= done;
+    replay(key, w);
+  }
+
+protected:
+  struct source {
+    Iter cur;
+    Iter last;
+  };
+  //结点中源的编号的最高位表示它已经耗尽, 耗尽的源的key仍然指向一个有效的元素,
+  //比较时可以照常解引用, 结果由这一位决定; 带上这一位后编号的大小关系正好也是平局时的先后
+  static const size_type done = ~(~size_type(0) >> 1);
+
+  //源a(当前元素为*ka)是否排在源b前面, 耗尽的源排在最后
+  bool beats(const value_type *ka, size_type a, const value_type *kb, size_type b) const {
+    using cheap = typename __bool_type<__cheap_compare<value_type, Compare>::value>::type;
+    return ((a & done) == 0) & (((b & done) != 0) | wins(ka, a, kb, b, cheap()));
+  }
+  //内置类型的比较很便宜, 两次比较的读取都不依赖对方, 比只比较一次但按编号交换参数的依赖链更短
+  bool wins(const value_type *ka, size_type a, const value_type *kb, size_type b, _true_type) const {
+    const bool lt = comp(*ka, *kb), gt = comp(*kb, *ka);
+    return lt | ((a < b) & !gt);
+  }
+  //其它情况只调用一次comp: 编号小的一方平局也获胜, 所以a < b时判断!(*kb < *ka), 否则判断*ka < *kb,
+  //两种情况只是交换了参数, 用异或按a < b交换两个指针, 比较结果再与a < b异或;
+  //写成a < b ? ... : ...会变成一个无法预测的条件跳转
+  bool wins(const value_type *ka, size_type a, const value_type *kb, size_type b, _false_type) const {
+    const bool a_first = a < b;
+    const uintptr_t dk = (reinterpret_cast<uintptr_t>(ka) ^ reinterpret_cast<uintptr_t>(kb)) &
+                         (uintptr_t(0) - uintptr_t(a_first));
+    const value_type *x = reinterpret_cast<const value_type *>(reinterpret_cast<uintptr_t>(ka) ^ dk);
+    const value_type *y = reinterpret_cast<const value_type *>(reinterpret_cast<uintptr_t>(kb) ^ dk);
+    return comp(*x, *y) != a_first;
+  }
+  void replay(const value_type *key, size_type w);
+
+  Compare comp;
+  jan::vector<source> src;
+  jan::vector<const value_type *> _key;
+  jan::vector<size_type> _src;
+};
+
+template <typename Iter, typename Compare>
+const typename loser_tree<Iter, Compare>::size_type loser_tree<Iter, Compare>::done;
+
+/**
+ * @brief 自底向上比赛一轮, 每个内部结点记下败者, 胜者继续往上比
+ *        一开始就为空的源借用一个非空源的元素作为key
+ *
+ * @tparam Iter
+ * @tparam Compare
+ */
+template <typename Iter, typename Compare> void loser_tree<Iter, Compare>::build() {
+  const size_type k = src.size();
+  _key.clear();
+  _src.clear();
+  if (k == 0)
+    return;
+  const value_type *any = nullptr;
+  for (size_type i = 0; i < k && any == nullptr; ++i)
+    if (src[i].cur != src[i].last)
+      any = &*src[i].cur;
+  //叶子和各层的胜者, 下标与树中的结点一致
+  jan::vector<const value_type *> win_key;
+  jan::vector<size_type> win_src;
+  win_key.resize(2 * k, any);
+  win_src.resize(2 * k, 0);
+  for (size_type i = 0; i < k; ++i)
+    if (src[i].cur != src[i].last) {
+      win_key[i + k] = &*src[i].cur;
+      win_src[i + k] = i;
+    } else
+      win_src[i + k] = i | done;
+  _key.resize(k, win_key[k]);
+  _src.resize(k, win_src[k]);
+  //全部为空时没有可以解引用的元素, 也不需要比赛
+  if (any == nullptr || k == 1)
+    return;
+  for (size_type i = k - 1; i >= 1; --i) {
+    const size_type l = 2 * i, r = 2 * i + 1;
+    const bool l_wins = beats(win_key[l], win_src[l], win_key[r], win_src[r]);
+    const size_type w = l_wins ? l : r, o = l_wins ? r : l;
+    win_key[i] = win_key[w];
+    win_src[i] = win_src[w];
+    _key[i] = win_key[o];
+    _src[i] = win_src[o];
+  }
+  _key[0] = win_key[1];
+  _src[0] = win_src[1];
+}
+
+//胜者的源前进了一步, 从它的叶子往上和各层的败者重新比赛
+template <typename Iter, typename Compare>
+void loser_tree<Iter, Compare>::replay(const value_type *key, size_type w) {
+  for (size_type i = ((w & ~done) + src.size()) / 2; i >= 1; i /= 2) {
+    const value_type *tk = _key[i];
+    const size_type t = _src[i];
+    //只比较一次时*tk的加载依赖上一层的结果, 先预取它所在的缓存行
+    jan::__prefetch(tk);
+    //swap时mask全为1, 用异或交换代替?:, 否则编译器会把它变回条件跳转
+    const uintptr_t mask = uintptr_t(0) - uintptr_t(beats(tk, t, key, w));
+    const uintptr_t dk = (reinterpret_cast<uintptr_t>(tk) ^ reinterpret_cast<uintptr_t>(key)) & mask;
+    const size_type ds = (t ^ w) & mask;
+    _key[i] = reinterpret_cast<const value_type *>(reinterpret_cast<uintptr_t>(tk) ^ dk);
+    _src[i] = t ^ ds;
+    key = reinterpret_cast<const value_type *>(reinterpret_cast<uintptr_t>(key) ^ dk);
+    w ^= ds;
+  }
+  _key[0] = key;
+  _src[0] = w;
+}
+
+//C++11没有std::void_t
+template <typename...> struct __void_t_helper { typedef void type; };
+
+/**
+ * @brief 取出ranges中一个区间的首尾迭代器, 区间可以是有begin()/end()的容器,
+ *        也可以是first/second为首尾迭代器的pair
+ *
+ * @tparam R
+ */
+template <typename R, typename = void> struct __range_access {
+  typedef typename std::decay<decltype(std::declval<const R &>().first)>::type iterator;
+  static iterator begin(const R &r) { return r.first; }
+  static iterator end(const R &r) { return r.second; }
+};
+
+template <typename R>
+struct __range_access<R, typename __void_t_helper<decltype(std::declval<const R &>().begin())>::type> {
+  typedef decltype(std::declval<const R &>().begin()) iterator;
+  static iterator begin(const R &r) { return r.begin(); }
+  static iterator end(const R &r) { return r.end(); }
+};
+
+template <typename Ranges> struct __ranges_traits {
+  typedef typename std::decay<decltype(*std::declval<const Ranges &>().begin())>::type range_type;
+  typedef __range_access<range_type> access;
+  typedef typename access::iterator iterator;
+  typedef typename iterator_traits<iterator>::value_type value_type;
+};
+
+/**
+ * @brief k路归并: ranges中的每个区间都已按comp有序, 把它们稳定地归并到res, 返回写完后的res
+ *        跳过空区间后只剩一个区间时直接拷贝, 两个时用jan::merge, 更多时用败者树,
+ *        每个输出元素约log2(k)次比较, 总代价O(n*log(k)), 两两链式归并则是O(n*k)
+ *
+ * @tparam Ranges 区间的容器, 元素是容器或首尾迭代器的pair
+ * @tparam OutputIter
+ * @tparam Compare
+ * @param ranges
+ * @param res
+ * @param comp
+ * @return OutputIter
+ */
+template <typename Ranges, typename OutputIter, typename Compare>
+OutputIter merge_k(const Ranges &ranges, OutputIter res, Compare comp) {
+  typedef __ranges_traits<Ranges> traits;
+  typedef typename traits::access access;
+  typedef typename traits::iterator Iter;
+  jan::vector<std::pair<Iter, Iter>> runs;
+  for (auto it = ranges.begin(); it != ranges.end(); ++it)
+    if (access::begin(*it) != access::end(*it))
+      runs.emplace_back(access::begin(*it), access::end(*it));
+  if (runs.empty())
+    return res;
+  if (runs.size() == 1)
+    return jan::copy(runs[0].first, runs[0].second, res);
+  if (runs.size() == 2)
+    return jan::merge(runs[0].first, runs[0].second, runs[1].first, runs[1].second, res, comp);
+  loser_tree<Iter, Compare> tree(comp);
+  for (size_t i = 0; i < runs.size(); ++i)
+    tree.add_source(runs[i].first, runs[i].second);
+  tree.build();
+  for (; !tree.empty(); tree.pop(), ++res)
+    *res = tree.top();
+  return res;
+}
+
+template <typename Ranges, typename OutputIter>
+inline OutputIter merge_k(const Ranges &ranges, OutputIter res) {
+  typedef typename __ranges_traits<Ranges>::value_type T;
+  return jan::merge_k(ranges, res, jan::less<T>());
+}
+
+/**
+ * @brief 批量输出的k路归并, 结果追加到out的末尾
+ *        先按总长度一次性扩容, 败者树的输出先攒到一个小缓冲区里, 满了再整块append,
+ *        省掉逐个emplace_back的容量检查, POD类型每批只是一次memmove
+ *
+ * @tparam Ranges
+ * @tparam T
+ * @tparam Alloc
+ * @tparam Compare
+ * @param ranges
+ * @param out
+ * @param comp
+ */
+template <typename Ranges, typename T, typename Alloc, typename Compare>
+void merge_k(const Ranges &ranges, jan::vector<T, Alloc> &out, Compare comp) {
+  typedef __ranges_traits<Ranges> traits;
+  typedef typename traits::access access;
+  typedef typename traits::iterator Iter;
+  enum { batch_size = 256 };
+  size_t total = 0;
+  loser_tree<Iter, Compare> tree(comp);
+  for (auto it = ranges.begin(); it != ranges.end(); ++it)
+    if (access::begin(*it) != access::end(*it)) {
+      total += jan::distance(access::begin(*it), access::end(*it));
+      tree.add_source(access::begin(*it), access::end(*it));
+    }
+  out.reserve(out.size() + total);
+  tree.build();
+  jan::vector<T> batch;
+  batch.reserve(batch_size);
+  while (!tree.empty()) {
+    batch.clear();
+    for (size_t i = 0; i < batch_size && !tree.empty(); ++i, tree.pop())
+      batch.emplace_back(tree.top());
+    out.append(batch.begin(), batch.end());
+  }
+}
+
+template <typename Ranges, typename T, typename Alloc>
+inline void merge_k(const Ranges &ranges, jan::vector<T, Alloc> &out) {
+  jan::merge_k(ranges, out, jan::less<T>());
+}
+
+} // namespace jan
+
+#endif
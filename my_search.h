@@ -0,0 +1,322 @@
+#ifndef __MY_SEARCH_H_
+#define __MY_SEARCH_H_
+
+#include "my_functional.h"
+#include "my_simd.h"
+#include "my_vector.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 只读查找表的两种缓存友好的布局, 都由一个有序区间(通常是有序的jan::vector)构建一次,
+ * 之后只查找不修改:
+ *   eytzinger_array  按二叉树的层序(BFS)存放, 结点k的孩子是2k和2k+1,
+ *                    前几层集中在开头的几个缓存行里, 每次查找可以提前几层预取
+ *   bplus_array      静态B+树, 叶子层就是有序数组本身, 内部结点每个B个键,
+ *                    一个结点占一个缓存行, 一次查找只访问树高个(约log_{B+1}n)缓存行
+ * 两者的查找循环都没有依赖比较结果的分支, 循环次数只与元素个数有关
+ */
+
+#if defined(__GNUC__)
+#define __JAN_PREFETCH(addr) __builtin_prefetch(reinterpret_cast<const void *>(addr))
+#else
+#define __JAN_PREFETCH(addr) ((void)0)
+#endif
+
+namespace jan {
+
+enum { __CACHE_LINE = 64 };
+
+//缓冲区中从哪个下标开始使得&buf[off]按缓存行对齐, sizeof(T)不整除缓存行时不对齐
+template <typename T> inline size_t __cache_line_offset(const T *buf)
+{
+  if (__CACHE_LINE % sizeof(T) != 0)
+    return 0;
+  const uintptr_t mis = reinterpret_cast<uintptr_t>(buf) % __CACHE_LINE;
+  return mis == 0 ? 0 : (__CACHE_LINE - mis) / sizeof(T);
+}
+
+/**
+ * @brief Eytzinger布局的有序表, 下标从1开始, 结点k的孩子是2k和2k+1
+ *        查找从根出发每层做k = 2k + (a[k] < val), 走到叶子之外后去掉末尾连续的1
+ *        (最后一次向左拐之后的那些向右拐)就得到答案; 下标0放在缓存行的开头,
+ *        于是结点k往下第log2(64 / sizeof(T))层的后代正好占满一个缓存行, 查找时提前预取它们
+ *        查找结果是指向布局中元素的指针, 没有满足条件的元素时为nullptr
+ *
+ * @tparam T
+ * @tparam Compare
+ */
+template <typename T, typename Compare = jan::less<T>> class eytzinger_array {
+public:
+  using value_type = T;
+  using size_type = size_t;
+
+  eytzinger_array() : _n(0), _off(0), comp() {}
+
+  //[first,last)必须已经按comp有序
+  template <typename RandomIter>
+  eytzinger_array(RandomIter first, RandomIter last, const Compare &cmp = Compare())
+      : _n(last - first), _off(0), comp(cmp) {
+    build(first);
+  }
+
+  template <typename Alloc>
+  explicit eytzinger_array(const jan::vector<T, Alloc> &sorted, const Compare &cmp = Compare())
+      : _n(sorted.size()), _off(0), comp(cmp) {
+    build(sorted.begin());
+  }
+
+  size_type size() const { return _n; }
+  bool empty() const { return _n == 0; }
+
+  //第一个不小于val的元素
+  const T *lower_bound(const T &val) const {
+    return search([&](const T &x) { return comp(x, val); });
+  }
+  //第一个大于val的元素
+  const T *upper_bound(const T &val) const {
+    return search([&](const T &x) { return !comp(val, x); });
+  }
+  bool contains(const T &val) const {
+    const T *p = lower_bound(val);
+    return p != nullptr && !comp(val, *p);
+  }
+
+protected:
+  //每个缓存行有多少个元素, 也就是预取时往下看几层的2的幂
+  static const size_type per_line = sizeof(T) < __CACHE_LINE ? __CACHE_LINE / sizeof(T) : 1;
+
+  const T *data() const { return _buf.begin() + _off; }
+
+  template <typename RandomIter> void build(RandomIter first);
+  template <typename RandomIter> RandomIter fill(RandomIter src, size_type k);
+  template <typename Before> const T *search(Before before) const;
+
+  size_type _n;
+  size_type _off; //data()[k]是结点k, 拷贝后的缓冲区不一定对齐, 所以存下标不存指针
+  Compare comp;
+  jan::vector<T> _buf;
+};
+
+template <typename T, typename Compare>
+const typename eytzinger_array<T, Compare>::size_type eytzinger_array<T, Compare>::per_line;
+
+/**
+ * @brief 多分配一个缓存行用于对齐, 多出来的位置和下标0都用第一个元素填充
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam RandomIter
+ * @param first
+ */
+template <typename T, typename Compare>
+template <typename RandomIter>
+void eytzinger_array<T, Compare>::build(RandomIter first) {
+  if (_n == 0)
+    return;
+  _buf.resize(_n + 1 + per_line, *first);
+  //让下标0落在缓存行的开头, 于是结点k * per_line开始的per_line个后代在同一个缓存行里
+  _off = jan::__cache_line_offset(_buf.begin());
+  fill(first, 1);
+}
+
+//按中序遍历把有序的元素依次放到以k为根的子树中, 返回用剩下的第一个元素
+template <typename T, typename Compare>
+template <typename RandomIter>
+RandomIter eytzinger_array<T, Compare>::fill(RandomIter src, size_type k) {
+  if (k <= _n) {
+    src = fill(src, 2 * k);
+    _buf[_off + k] = *src;
+    ++src;
+    src = fill(src, 2 * k + 1);
+  }
+  return src;
+}
+
+/**
+ * @brief 找第一个before(x)为false的元素, before必须在有序序列上先真后假
+ *
+ * @tparam T
+ * @tparam Compare
+ * @tparam Before
+ * @param before
+ * @return const T*
+ */
+template <typename T, typename Compare>
+template <typename Before>
+const T *eytzinger_array<T, Compare>::search(Before before) const {
+  const T *a = data();
+  const uintptr_t base = reinterpret_cast<uintptr_t>(a);
+  size_type k = 1;
+  while (k <= _n) {
+    //只是预取, 越过数组末尾也不会访问内存
+    __JAN_PREFETCH(base + k * per_line * sizeof(T));
+    k = 2 * k + (before(a[k]) ? 1 : 0);
+  }
+  //k的二进制是根到叶子的路径(1为向右), 答案是最后一次向左拐的那个结点
+  k >>= __builtin_ctzll(~static_cast<unsigned long long>(k)) + 1;
+  return k == 0 ? nullptr : a + k;
+}
+
+/**
+ * @brief 静态B+树布局的有序表, 叶子层是补齐到B的倍数的有序数组, 往上每层的结点有B个键和B+1个孩子,
+ *        第j个键是第j+1个孩子的子树中最小的元素; 查找时在结点里数出小于val的键的个数,
+ *        作为下一层的孩子编号, 没有分支; 到叶子后再数一次就得到val在有序数组中的位置
+ *        4/8字节的整数键配jan::less时用my_simd.h中cmpgt/movemask/popcount的核心计数
+ *        B个键连续存放, B * sizeof(T)为64时一个结点正好是一个缓存行
+ *        结果是有序数组中的下标, 可以直接用来访问与之平行的数据; 没有满足条件的元素时为size()
+ *
+ * @tparam T
+ * @tparam B 每个结点的键数
+ * @tparam Compare
+ */
+template <typename T, size_t B = (sizeof(T) < __CACHE_LINE ? __CACHE_LINE / sizeof(T) : 2),
+          typename Compare = jan::less<T>>
+class bplus_array {
+public:
+  using value_type = T;
+  using size_type = size_t;
+
+  bplus_array() : _n(0), _off(0), comp() {}
+
+  //[first,last)必须已经按comp有序
+  template <typename RandomIter>
+  bplus_array(RandomIter first, RandomIter last, const Compare &cmp = Compare())
+      : _n(last - first), _off(0), comp(cmp) {
+    build(first);
+  }
+
+  template <typename Alloc>
+  explicit bplus_array(const jan::vector<T, Alloc> &sorted, const Compare &cmp = Compare())
+      : _n(sorted.size()), _off(0), comp(cmp) {
+    build(sorted.begin());
+  }
+
+  size_type size() const { return _n; }
+  bool empty() const { return _n == 0; }
+  //有序数组中的第i个元素
+  const T &operator[](size_type i) const { return _buf[_off + i]; }
+
+  size_type lower_bound(const T &val) const {
+    return bound(val, false, typename __simd_rank_traits<T, Compare>::vectorizable());
+  }
+  size_type upper_bound(const T &val) const {
+    return bound(val, true, typename __simd_rank_traits<T, Compare>::vectorizable());
+  }
+  bool contains(const T &val) const {
+    size_type i = lower_bound(val);
+    return i != _n && !comp(val, (*this)[i]);
+  }
+
+protected:
+  template <typename RandomIter> void build(RandomIter first);
+  //rank(node)返回结点的B个键中排在查找目标之前的个数
+  template <typename Rank> size_type search(Rank rank) const;
+
+  size_type bound(const T &val, bool upper, _false_type) const {
+    if (upper)
+      return search([&](const T *node) { return rank_in_node(node, [&](const T &x) { return !comp(val, x); }); });
+    return search([&](const T *node) { return rank_in_node(node, [&](const T &x) { return comp(x, val); }); });
+  }
+#ifdef __JAN_SIMD_X86
+  //整数键配jan::less: 结点内用cmpgt/movemask/popcount计数
+  size_type bound(const T &val, bool upper, _true_type) const {
+    return search([&](const T *node) {
+      prefetch_node(node);
+      return jan::__simd_rank(node, B, val, upper);
+    });
+  }
+#endif
+
+  //结点超过一个缓存行时预取其余的行
+  static void prefetch_node(const T *node) {
+    for (size_type off = __CACHE_LINE; off < B * sizeof(T); off += __CACHE_LINE)
+      __JAN_PREFETCH(reinterpret_cast<uintptr_t>(node) + off);
+  }
+
+  //在一个结点的B个键中数出before为真的个数
+  template <typename Before> static size_type rank_in_node(const T *node, Before before) {
+    prefetch_node(node);
+    size_type cnt = 0;
+    for (size_type j = 0; j < B; ++j)
+      cnt += before(node[j]) ? 1 : 0;
+    return cnt;
+  }
+
+  size_type _n;
+  size_type _off;
+  Compare comp;
+  jan::vector<T> _buf;
+  //第l层(0为叶子)的第一个键在_buf + _off中的位置和这一层的结点数, 最后一层是根
+  jan::vector<size_type> _level_begin;
+  jan::vector<size_type> _level_nodes;
+};
+
+/**
+ * @brief 自底向上逐层构建: 叶子层拷贝有序数组, 不足B的部分用最后一个元素补齐;
+ *        第l + 1层第i个结点的第j个键取自第l层第i * (B + 1) + j + 1个结点的子树的第一个叶子,
+ *        这个孩子不存在时也用最后一个元素补齐, 查找时再把孩子编号截断到本层的最后一个结点
+ *
+ * @tparam T
+ * @tparam B
+ * @tparam Compare
+ * @tparam RandomIter
+ * @param first
+ */
+template <typename T, size_t B, typename Compare>
+template <typename RandomIter>
+void bplus_array<T, B, Compare>::build(RandomIter first) {
+  static_assert(B >= 1, "node must hold at least one key");
+  if (_n == 0)
+    return;
+  size_type total = 0;
+  for (size_type nodes = (_n + B - 1) / B;; nodes = (nodes + B) / (B + 1)) {
+    _level_begin.push_back(total);
+    _level_nodes.push_back(nodes);
+    total += nodes * B;
+    if (nodes == 1)
+      break;
+  }
+  const T &max = *(first + (_n - 1));
+  const size_type per_line = sizeof(T) < __CACHE_LINE ? __CACHE_LINE / sizeof(T) : 1;
+  _buf.resize(total + per_line, max);
+  _off = jan::__cache_line_offset(_buf.begin());
+  T *keys = _buf.begin() + _off;
+  for (size_type i = 0; i < _n; ++i)
+    keys[i] = *(first + i);
+  //span为第l层的一个结点覆盖的叶子元素个数
+  size_type span = B;
+  for (size_type l = 0; l + 1 < _level_begin.size(); ++l, span *= B + 1) {
+    T *node = keys + _level_begin[l + 1];
+    for (size_type i = 0; i < _level_nodes[l + 1]; ++i)
+      for (size_type j = 0; j < B; ++j, ++node) {
+        size_type leaf = (i * (B + 1) + j + 1) * span;
+        if (leaf < _n)
+          *node = *(first + leaf);
+      }
+  }
+}
+
+template <typename T, size_t B, typename Compare>
+template <typename Rank>
+typename bplus_array<T, B, Compare>::size_type
+bplus_array<T, B, Compare>::search(Rank rank) const {
+  if (_n == 0)
+    return 0;
+  const T *keys = _buf.begin() + _off;
+  size_type node = 0;
+  for (size_type l = _level_begin.size() - 1; l > 0; --l) {
+    node = node * (B + 1) + rank(keys + _level_begin[l] + node * B);
+    //最后一个结点的孩子不满B + 1个, 越界时说明所有元素都在val之前
+    const size_type last = _level_nodes[l - 1] - 1;
+    node = node < last ? node : last;
+  }
+  const size_type ret = node * B + rank(keys + node * B);
+  return ret < _n ? ret : _n;
+}
+
+} // namespace jan
+
+#undef __JAN_PREFETCH
+
+#endif
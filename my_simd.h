@@ -0,0 +1,1098 @@
+#ifndef __MY_SIMD_H_
+#define __MY_SIMD_H_
+
+#include "my_functional.h"
+#include "my_type_traits.h"
+#include <cstddef>
+
+/**
+ * 连续存放的int/float/double上find, count, accumulate, inner_product的向量化版本,
+ * 以及copy, fill用到的non-temporal拷贝和按模式填充, 4/8字节整数的求交集与前缀和
+ * 每个指令集(SSE2, AVX2+FMA, AVX-512)各有一组核心, 第一次调用时用
+ * __builtin_cpu_supports选出本机支持的最宽的一组, 之后通过函数指针调用
+ * 编译器或平台不支持时__simd_type全部为_false_type, 算法退回普通的循环
+ *
+ * 求和与内积用4组向量累加器打断循环依赖, 对浮点数来说加法顺序与逐个累加不同,
+ * 结果可能有舍入上的差别
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define __JAN_SIMD_X86 1
+#include <immintrin.h>
+#define __JAN_SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace jan {
+
+inline size_t __default_streaming_threshold()
+{
+#ifdef _SC_LEVEL3_CACHE_SIZE
+  long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  if (llc > 0)
+    return static_cast<size_t>(llc);
+#endif
+  return 8 << 20;
+}
+
+inline std::atomic<size_t> &__streaming_threshold()
+{
+  static std::atomic<size_t> bytes(jan::__default_streaming_threshold());
+  return bytes;
+}
+
+/**
+ * @brief copy, fill, fill_n在trivial类型的连续区间上写入的字节数不小于此值时,
+ *        改用non-temporal写, 数据直接写回内存而不占用缓存, 避免把正在使用的数据挤出LLC
+ *        默认为LLC的大小(取不到时为8MB)
+ *
+ * @return size_t
+ */
+inline size_t streaming_threshold()
+{
+  return jan::__streaming_threshold().load(std::memory_order_relaxed);
+}
+
+inline void set_streaming_threshold(size_t bytes)
+{
+  jan::__streaming_threshold().store(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 类型T是否有向量化的核心, vectorizable为_true_type或_false_type
+ *
+ * @tparam T
+ */
+template <typename T> struct __simd_type {
+  typedef _false_type vectorizable;
+};
+
+#ifdef __JAN_SIMD_X86
+template <> struct __simd_type<int> {
+  typedef _true_type vectorizable;
+};
+template <> struct __simd_type<float> {
+  typedef _true_type vectorizable;
+};
+template <> struct __simd_type<double> {
+  typedef _true_type vectorizable;
+};
+#endif
+
+/**
+ * @brief 迭代器Iter是否是指向T的指针并且T可以向量化, 用于算法的分派
+ *
+ * @tparam Iter
+ * @tparam T
+ */
+template <typename Iter, typename T> struct __simd_traits {
+  typedef _false_type vectorizable;
+};
+template <typename T> struct __simd_traits<T *, T> {
+  typedef typename __simd_type<T>::vectorizable vectorizable;
+};
+template <typename T> struct __simd_traits<const T *, T> {
+  typedef typename __simd_type<T>::vectorizable vectorizable;
+};
+
+/**
+ * @brief T是否是4或8字节的整数, 求交集的块比较和前缀和的寄存器内扫描只看位模式,
+ *        有符号与无符号共用一份实现
+ *
+ * @tparam T
+ */
+template <typename T, size_t = sizeof(T)> struct __simd_int_type {
+  typedef _false_type vectorizable;
+};
+
+#ifdef __JAN_SIMD_X86
+template <typename T> struct __simd_int_type<T, 4> {
+  typedef typename is_integer<T>::integral vectorizable;
+};
+template <typename T> struct __simd_int_type<T, 8> {
+  typedef typename is_integer<T>::integral vectorizable;
+};
+#endif
+
+//严格递增的两个区间求交集: 指向同一种整数的指针, 结果也写到这种指针
+template <typename Iter1, typename Iter2, typename Out> struct __simd_set_traits {
+  typedef _false_type vectorizable;
+};
+template <typename T> struct __simd_set_traits<T *, T *, T *> : __simd_int_type<T> {
+};
+template <typename T> struct __simd_set_traits<const T *, const T *, T *> : __simd_int_type<T> {
+};
+
+//前缀和: op是jan::plus<T>, 输入输出都是指向T的指针, 累加值的类型也是T
+template <typename InputIter, typename OutputIter, typename BinaryOp, typename T>
+struct __simd_scan_traits {
+  typedef _false_type vectorizable;
+};
+template <typename T> struct __simd_scan_traits<T *, T *, plus<T>, T> : __simd_int_type<T> {
+};
+template <typename T> struct __simd_scan_traits<const T *, T *, plus<T>, T> : __simd_int_type<T> {
+};
+
+//有序表结点内计数: comp是jan::less<T>, T是4或8字节的整数
+template <typename T, typename Compare> struct __simd_rank_traits {
+  typedef _false_type vectorizable;
+};
+template <typename T> struct __simd_rank_traits<T, less<T>> : __simd_int_type<T> {
+};
+
+/**
+ * @brief T是否是整数(任意宽度), 整数相等就是所有字节相等, mismatch和lexicographical_compare
+ *        可以先按字节块找到第一个不同的元素, 再只比较这一个元素
+ *
+ * @tparam T
+ */
+template <typename T> struct __simd_bytewise_type {
+#ifdef __JAN_SIMD_X86
+  typedef typename is_integer<T>::integral vectorizable;
+#else
+  typedef _false_type vectorizable;
+#endif
+};
+
+//逐个比较两个区间: 都是指向同一种整数的指针, 可以带const
+template <typename Iter1, typename Iter2> struct __simd_cmp_traits {
+  typedef _false_type vectorizable;
+};
+template <typename T> struct __simd_cmp_traits<T *, T *> : __simd_bytewise_type<T> {
+};
+template <typename T> struct __simd_cmp_traits<const T *, T *> : __simd_bytewise_type<T> {
+};
+template <typename T> struct __simd_cmp_traits<T *, const T *> : __simd_bytewise_type<T> {
+};
+template <typename T> struct __simd_cmp_traits<const T *, const T *> : __simd_bytewise_type<T> {
+};
+
+template <typename A, typename B> struct __tag_and {
+  typedef _false_type type;
+};
+template <> struct __tag_and<_true_type, _true_type> {
+  typedef _true_type type;
+};
+
+#ifdef __JAN_SIMD_X86
+
+//把一个向量的各个分量按顺序加起来
+template <typename T, size_t Lanes> inline T __simd_reduce(const T *lanes)
+{
+  T ret = lanes[0];
+  for (size_t i = 1; i < Lanes; ++i)
+    ret += lanes[i];
+  return ret;
+}
+
+/**
+ * 每个指令集和元素类型的基本操作, 核心只通过它们访问向量:
+ *   vec, lanes        向量类型和它包含的元素个数
+ *   load(p)           从p读一个向量, p不需要对齐
+ *   set1(x), zero()   所有分量都是x / 0
+ *   add(a, b)         逐分量相加
+ *   madd(acc, a, b)   acc + a * b
+ *   eq_mask(a, b)     逐分量比较, 相等的分量对应的位为1
+ *   popcount(m)       eq_mask结果中1的个数
+ *   reduce(v)         所有分量之和
+ * int的那一组还当作字节向量用于拷贝和填充:
+ *   store(p, v)       把v写到p, p不需要对齐
+ *   stream(p, v)      non-temporal写, p必须按向量的大小对齐
+ */
+template <typename T> struct __sse2_ops;
+template <typename T> struct __avx2_ops;
+template <typename T> struct __avx512_ops;
+
+#define __JAN_SSE2 __JAN_SIMD_TARGET("sse2")
+
+//SSE2不一定有popcnt指令, 掩码最多4位, 查一个按4位打包的表
+inline unsigned __popcount4(unsigned m) { return (0x4332322132212110ULL >> (m * 4)) & 0xF; }
+
+template <> struct __sse2_ops<int> {
+  typedef int value_type;
+  typedef __m128i vec;
+  static const size_t lanes = 4;
+  __JAN_SSE2 static vec load(const int *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+  __JAN_SSE2 static void store(int *p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+  __JAN_SSE2 static void stream(int *p, vec v) { _mm_stream_si128(reinterpret_cast<__m128i *>(p), v); }
+  __JAN_SSE2 static vec set1(int x) { return _mm_set1_epi32(x); }
+  __JAN_SSE2 static vec zero() { return _mm_setzero_si128(); }
+  __JAN_SSE2 static vec add(vec a, vec b) { return _mm_add_epi32(a, b); }
+  //SSE2没有32位的低位乘法, 用两次32x32->64的乘法拼出来
+  __JAN_SSE2 static vec madd(vec acc, vec a, vec b)
+  {
+    vec even = _mm_mul_epu32(a, b);
+    vec odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    vec prod = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    return _mm_add_epi32(acc, prod);
+  }
+  __JAN_SSE2 static unsigned eq_mask(vec a, vec b)
+  {
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+  }
+  __JAN_SSE2 static unsigned popcount(unsigned m) { return jan::__popcount4(m); }
+  __JAN_SSE2 static int reduce(vec v)
+  {
+    alignas(16) int buf[lanes];
+    _mm_store_si128(reinterpret_cast<__m128i *>(buf), v);
+    return __simd_reduce<int, lanes>(buf);
+  }
+};
+
+template <> struct __sse2_ops<float> {
+  typedef float value_type;
+  typedef __m128 vec;
+  static const size_t lanes = 4;
+  __JAN_SSE2 static vec load(const float *p) { return _mm_loadu_ps(p); }
+  __JAN_SSE2 static vec set1(float x) { return _mm_set1_ps(x); }
+  __JAN_SSE2 static vec zero() { return _mm_setzero_ps(); }
+  __JAN_SSE2 static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+  __JAN_SSE2 static vec madd(vec acc, vec a, vec b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+  __JAN_SSE2 static unsigned eq_mask(vec a, vec b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+  __JAN_SSE2 static unsigned popcount(unsigned m) { return jan::__popcount4(m); }
+  __JAN_SSE2 static float reduce(vec v)
+  {
+    alignas(16) float buf[lanes];
+    _mm_store_ps(buf, v);
+    return __simd_reduce<float, lanes>(buf);
+  }
+};
+
+template <> struct __sse2_ops<double> {
+  typedef double value_type;
+  typedef __m128d vec;
+  static const size_t lanes = 2;
+  __JAN_SSE2 static vec load(const double *p) { return _mm_loadu_pd(p); }
+  __JAN_SSE2 static vec set1(double x) { return _mm_set1_pd(x); }
+  __JAN_SSE2 static vec zero() { return _mm_setzero_pd(); }
+  __JAN_SSE2 static vec add(vec a, vec b) { return _mm_add_pd(a, b); }
+  __JAN_SSE2 static vec madd(vec acc, vec a, vec b) { return _mm_add_pd(acc, _mm_mul_pd(a, b)); }
+  __JAN_SSE2 static unsigned eq_mask(vec a, vec b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+  __JAN_SSE2 static unsigned popcount(unsigned m) { return jan::__popcount4(m); }
+  __JAN_SSE2 static double reduce(vec v)
+  {
+    alignas(16) double buf[lanes];
+    _mm_store_pd(buf, v);
+    return __simd_reduce<double, lanes>(buf);
+  }
+};
+
+#undef __JAN_SSE2
+#define __JAN_AVX2 __JAN_SIMD_TARGET("avx2,fma,popcnt")
+
+template <> struct __avx2_ops<int> {
+  typedef int value_type;
+  typedef __m256i vec;
+  static const size_t lanes = 8;
+  __JAN_AVX2 static vec load(const int *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  __JAN_AVX2 static void store(int *p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+  __JAN_AVX2 static void stream(int *p, vec v) { _mm256_stream_si256(reinterpret_cast<__m256i *>(p), v); }
+  __JAN_AVX2 static vec set1(int x) { return _mm256_set1_epi32(x); }
+  __JAN_AVX2 static vec zero() { return _mm256_setzero_si256(); }
+  __JAN_AVX2 static vec add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+  __JAN_AVX2 static vec madd(vec acc, vec a, vec b) { return _mm256_add_epi32(acc, _mm256_mullo_epi32(a, b)); }
+  __JAN_AVX2 static unsigned eq_mask(vec a, vec b)
+  {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+  }
+  __JAN_AVX2 static unsigned popcount(unsigned m) { return __builtin_popcount(m); }
+  __JAN_AVX2 static int reduce(vec v)
+  {
+    alignas(32) int buf[lanes];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(buf), v);
+    return __simd_reduce<int, lanes>(buf);
+  }
+};
+
+template <> struct __avx2_ops<float> {
+  typedef float value_type;
+  typedef __m256 vec;
+  static const size_t lanes = 8;
+  __JAN_AVX2 static vec load(const float *p) { return _mm256_loadu_ps(p); }
+  __JAN_AVX2 static vec set1(float x) { return _mm256_set1_ps(x); }
+  __JAN_AVX2 static vec zero() { return _mm256_setzero_ps(); }
+  __JAN_AVX2 static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+  __JAN_AVX2 static vec madd(vec acc, vec a, vec b) { return _mm256_fmadd_ps(a, b, acc); }
+  __JAN_AVX2 static unsigned eq_mask(vec a, vec b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)); }
+  __JAN_AVX2 static unsigned popcount(unsigned m) { return __builtin_popcount(m); }
+  __JAN_AVX2 static float reduce(vec v)
+  {
+    alignas(32) float buf[lanes];
+    _mm256_store_ps(buf, v);
+    return __simd_reduce<float, lanes>(buf);
+  }
+};
+
+template <> struct __avx2_ops<double> {
+  typedef double value_type;
+  typedef __m256d vec;
+  static const size_t lanes = 4;
+  __JAN_AVX2 static vec load(const double *p) { return _mm256_loadu_pd(p); }
+  __JAN_AVX2 static vec set1(double x) { return _mm256_set1_pd(x); }
+  __JAN_AVX2 static vec zero() { return _mm256_setzero_pd(); }
+  __JAN_AVX2 static vec add(vec a, vec b) { return _mm256_add_pd(a, b); }
+  __JAN_AVX2 static vec madd(vec acc, vec a, vec b) { return _mm256_fmadd_pd(a, b, acc); }
+  __JAN_AVX2 static unsigned eq_mask(vec a, vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+  __JAN_AVX2 static unsigned popcount(unsigned m) { return __builtin_popcount(m); }
+  __JAN_AVX2 static double reduce(vec v)
+  {
+    alignas(32) double buf[lanes];
+    _mm256_store_pd(buf, v);
+    return __simd_reduce<double, lanes>(buf);
+  }
+};
+
+#undef __JAN_AVX2
+#define __JAN_AVX512 __JAN_SIMD_TARGET("avx512f,avx2,fma,popcnt")
+
+template <> struct __avx512_ops<int> {
+  typedef int value_type;
+  typedef __m512i vec;
+  static const size_t lanes = 16;
+  __JAN_AVX512 static vec load(const int *p) { return _mm512_loadu_si512(p); }
+  __JAN_AVX512 static void store(int *p, vec v) { _mm512_storeu_si512(p, v); }
+  __JAN_AVX512 static void stream(int *p, vec v) { _mm512_stream_si512(reinterpret_cast<__m512i *>(p), v); }
+  __JAN_AVX512 static vec set1(int x) { return _mm512_set1_epi32(x); }
+  __JAN_AVX512 static vec zero() { return _mm512_setzero_si512(); }
+  __JAN_AVX512 static vec add(vec a, vec b) { return _mm512_add_epi32(a, b); }
+  __JAN_AVX512 static vec madd(vec acc, vec a, vec b) { return _mm512_add_epi32(acc, _mm512_mullo_epi32(a, b)); }
+  __JAN_AVX512 static unsigned eq_mask(vec a, vec b) { return _mm512_cmpeq_epi32_mask(a, b); }
+  __JAN_AVX512 static unsigned popcount(unsigned m) { return __builtin_popcount(m); }
+  __JAN_AVX512 static int reduce(vec v)
+  {
+    alignas(64) int buf[lanes];
+    _mm512_store_si512(buf, v);
+    return __simd_reduce<int, lanes>(buf);
+  }
+};
+
+template <> struct __avx512_ops<float> {
+  typedef float value_type;
+  typedef __m512 vec;
+  static const size_t lanes = 16;
+  __JAN_AVX512 static vec load(const float *p) { return _mm512_loadu_ps(p); }
+  __JAN_AVX512 static vec set1(float x) { return _mm512_set1_ps(x); }
+  __JAN_AVX512 static vec zero() { return _mm512_setzero_ps(); }
+  __JAN_AVX512 static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+  __JAN_AVX512 static vec madd(vec acc, vec a, vec b) { return _mm512_fmadd_ps(a, b, acc); }
+  __JAN_AVX512 static unsigned eq_mask(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+  __JAN_AVX512 static unsigned popcount(unsigned m) { return __builtin_popcount(m); }
+  __JAN_AVX512 static float reduce(vec v)
+  {
+    alignas(64) float buf[lanes];
+    _mm512_store_ps(buf, v);
+    return __simd_reduce<float, lanes>(buf);
+  }
+};
+
+template <> struct __avx512_ops<double> {
+  typedef double value_type;
+  typedef __m512d vec;
+  static const size_t lanes = 8;
+  __JAN_AVX512 static vec load(const double *p) { return _mm512_loadu_pd(p); }
+  __JAN_AVX512 static vec set1(double x) { return _mm512_set1_pd(x); }
+  __JAN_AVX512 static vec zero() { return _mm512_setzero_pd(); }
+  __JAN_AVX512 static vec add(vec a, vec b) { return _mm512_add_pd(a, b); }
+  __JAN_AVX512 static vec madd(vec acc, vec a, vec b) { return _mm512_fmadd_pd(a, b, acc); }
+  __JAN_AVX512 static unsigned eq_mask(vec a, vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+  __JAN_AVX512 static unsigned popcount(unsigned m) { return __builtin_popcount(m); }
+  __JAN_AVX512 static double reduce(vec v)
+  {
+    alignas(64) double buf[lanes];
+    _mm512_store_pd(buf, v);
+    return __simd_reduce<double, lanes>(buf);
+  }
+};
+
+#undef __JAN_AVX512
+
+/**
+ * 用Ops写出的核心, 每次处理4个向量; 同一份代码要分别按每个指令集编译,
+ * 而target属性不能作为模板参数, 所以用宏为每个指令集生成一个结构体:
+ *   find        4个向量的比较结果合在一起检查, 命中后在这一段里逐个找
+ *   count       每个向量比较结果的置位数之和
+ *   sum,dot     4个互相独立的累加器, 最后再合并
+ *   stream_copy 先把dst对齐到向量大小, 中间用non-temporal写, 首尾用memcpy
+ *   fill        把从dst开始的64字节模式pattern重复写满n字节, stream时dst必须按64字节对齐
+ */
+#define __JAN_SIMD_KERNELS(Name, Isa)                                          \
+  struct Name {                                                                \
+    template <typename Ops, typename T>                                        \
+    __JAN_SIMD_TARGET(Isa)                                                     \
+    static const T *find(const T *first, const T *last, T val)                 \
+    {                                                                          \
+      const ptrdiff_t L = Ops::lanes;                                          \
+      const typename Ops::vec v = Ops::set1(val);                              \
+      for (; last - first >= 4 * L; first += 4 * L)                            \
+        if (Ops::eq_mask(Ops::load(first), v) |                                \
+            Ops::eq_mask(Ops::load(first + L), v) |                            \
+            Ops::eq_mask(Ops::load(first + 2 * L), v) |                        \
+            Ops::eq_mask(Ops::load(first + 3 * L), v))                         \
+          break;                                                               \
+      for (; first != last; ++first)                                           \
+        if (*first == val)                                                     \
+          break;                                                               \
+      return first;                                                            \
+    }                                                                          \
+    template <typename Ops, typename T>                                        \
+    __JAN_SIMD_TARGET(Isa)                                                     \
+    static size_t count(const T *first, const T *last, T val)                  \
+    {                                                                          \
+      const ptrdiff_t L = Ops::lanes;                                          \
+      const typename Ops::vec v = Ops::set1(val);                              \
+      size_t ret = 0;                                                          \
+      for (; last - first >= 4 * L; first += 4 * L)                            \
+        ret += Ops::popcount(Ops::eq_mask(Ops::load(first), v)) +              \
+               Ops::popcount(Ops::eq_mask(Ops::load(first + L), v)) +          \
+               Ops::popcount(Ops::eq_mask(Ops::load(first + 2 * L), v)) +      \
+               Ops::popcount(Ops::eq_mask(Ops::load(first + 3 * L), v));       \
+      for (; first != last; ++first)                                           \
+        if (*first == val)                                                     \
+          ++ret;                                                               \
+      return ret;                                                              \
+    }                                                                          \
+    template <typename Ops, typename T>                                        \
+    __JAN_SIMD_TARGET(Isa)                                                     \
+    static T sum(const T *first, const T *last)                                \
+    {                                                                          \
+      const ptrdiff_t L = Ops::lanes;                                          \
+      typename Ops::vec a0 = Ops::zero(), a1 = a0, a2 = a0, a3 = a0;           \
+      for (; last - first >= 4 * L; first += 4 * L)                            \
+      {                                                                        \
+        a0 = Ops::add(a0, Ops::load(first));                                   \
+        a1 = Ops::add(a1, Ops::load(first + L));                               \
+        a2 = Ops::add(a2, Ops::load(first + 2 * L));                           \
+        a3 = Ops::add(a3, Ops::load(first + 3 * L));                           \
+      }                                                                        \
+      for (; last - first >= L; first += L)                                    \
+        a0 = Ops::add(a0, Ops::load(first));                                   \
+      T ret = Ops::reduce(Ops::add(Ops::add(a0, a1), Ops::add(a2, a3)));       \
+      for (; first != last; ++first)                                           \
+        ret += *first;                                                         \
+      return ret;                                                              \
+    }                                                                          \
+    template <typename Ops, typename T>                                        \
+    __JAN_SIMD_TARGET(Isa)                                                     \
+    static T dot(const T *first1, const T *last1, const T *first2)             \
+    {                                                                          \
+      const ptrdiff_t L = Ops::lanes;                                          \
+      typename Ops::vec a0 = Ops::zero(), a1 = a0, a2 = a0, a3 = a0;           \
+      for (; last1 - first1 >= 4 * L; first1 += 4 * L, first2 += 4 * L)       \
+      {                                                                        \
+        a0 = Ops::madd(a0, Ops::load(first1), Ops::load(first2));              \
+        a1 = Ops::madd(a1, Ops::load(first1 + L), Ops::load(first2 + L));      \
+        a2 = Ops::madd(a2, Ops::load(first1 + 2 * L),                          \
+                       Ops::load(first2 + 2 * L));                             \
+        a3 = Ops::madd(a3, Ops::load(first1 + 3 * L),                          \
+                       Ops::load(first2 + 3 * L));                             \
+      }                                                                        \
+      for (; last1 - first1 >= L; first1 += L, first2 += L)                    \
+        a0 = Ops::madd(a0, Ops::load(first1), Ops::load(first2));              \
+      T ret = Ops::reduce(Ops::add(Ops::add(a0, a1), Ops::add(a2, a3)));       \
+      for (; first1 != last1; ++first1, ++first2)                              \
+        ret += *first1 * *first2;                                              \
+      return ret;                                                              \
+    }                                                                          \
+    template <typename Ops>                                                    \
+    __JAN_SIMD_TARGET(Isa)                                                     \
+    static void stream_copy(char *dst, const char *src, size_t n)              \
+    {                                                                          \
+      const size_t W = Ops::lanes * sizeof(int);                               \
+      size_t head = (W - reinterpret_cast<uintptr_t>(dst) % W) % W;            \
+      if (head > n)                                                            \
+        head = n;                                                              \
+      memcpy(dst, src, head);                                                  \
+      dst += head, src += head, n -= head;                                     \
+      for (; n >= 4 * W; dst += 4 * W, src += 4 * W, n -= 4 * W)               \
+      {                                                                        \
+        typename Ops::vec v0 = Ops::load(reinterpret_cast<const int *>(src));  \
+        typename Ops::vec v1 = Ops::load(reinterpret_cast<const int *>(src + W)); \
+        typename Ops::vec v2 =                                                 \
+            Ops::load(reinterpret_cast<const int *>(src + 2 * W));             \
+        typename Ops::vec v3 =                                                 \
+            Ops::load(reinterpret_cast<const int *>(src + 3 * W));             \
+        Ops::stream(reinterpret_cast<int *>(dst), v0);                         \
+        Ops::stream(reinterpret_cast<int *>(dst + W), v1);                     \
+        Ops::stream(reinterpret_cast<int *>(dst + 2 * W), v2);                 \
+        Ops::stream(reinterpret_cast<int *>(dst + 3 * W), v3);                 \
+      }                                                                        \
+      for (; n >= W; dst += W, src += W, n -= W)                               \
+        Ops::stream(reinterpret_cast<int *>(dst),                              \
+                    Ops::load(reinterpret_cast<const int *>(src)));            \
+      memcpy(dst, src, n);                                                     \
+      _mm_sfence();                                                            \
+    }                                                                          \
+    template <typename Ops>                                                    \
+    __JAN_SIMD_TARGET(Isa)                                                     \
+    static void fill(char *dst, size_t n, const char *pattern, bool stream)    \
+    {                                                                          \
+      const size_t W = Ops::lanes * sizeof(int);                               \
+      const typename Ops::vec v = Ops::load(reinterpret_cast<const int *>(pattern)); \
+      int *p = reinterpret_cast<int *>(dst);                                   \
+      const size_t step = Ops::lanes;                                          \
+      for (; n >= 4 * W; p += 4 * step, n -= 4 * W)                            \
+        if (stream)                                                            \
+        {                                                                      \
+          Ops::stream(p, v);                                                   \
+          Ops::stream(p + step, v);                                            \
+          Ops::stream(p + 2 * step, v);                                        \
+          Ops::stream(p + 3 * step, v);                                        \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+          Ops::store(p, v);                                                    \
+          Ops::store(p + step, v);                                             \
+          Ops::store(p + 2 * step, v);                                         \
+          Ops::store(p + 3 * step, v);                                         \
+        }                                                                      \
+      for (; n >= W; p += step, n -= W)                                        \
+        stream ? Ops::stream(p, v) : Ops::store(p, v);                         \
+      memcpy(p, pattern, n);                                                   \
+      if (stream)                                                              \
+        _mm_sfence();                                                          \
+    }                                                                          \
+  };
+
+__JAN_SIMD_KERNELS(__simd_sse2, "sse2")
+__JAN_SIMD_KERNELS(__simd_avx2, "avx2,fma,popcnt")
+__JAN_SIMD_KERNELS(__simd_avx512, "avx512f,avx2,fma,popcnt")
+
+#undef __JAN_SIMD_KERNELS
+
+/**
+ * @brief 元素类型为T的一组核心的入口
+ *
+ * @tparam T
+ */
+template <typename T> struct __simd_kernel_table {
+  const T *(*find)(const T *, const T *, T);
+  size_t (*count)(const T *, const T *, T);
+  T (*sum)(const T *, const T *);
+  T (*dot)(const T *, const T *, const T *);
+  const char *isa;
+};
+
+template <typename Kernels, typename Ops>
+inline __simd_kernel_table<typename Ops::value_type> __simd_make_table(const char *isa)
+{
+  typedef typename Ops::value_type T;
+  __simd_kernel_table<T> ret = {&Kernels::template find<Ops, T>,
+                                &Kernels::template count<Ops, T>,
+                                &Kernels::template sum<Ops, T>,
+                                &Kernels::template dot<Ops, T>, isa};
+  return ret;
+}
+
+//检测本机支持的最宽的指令集: 0为SSE2, 1为AVX2+FMA, 2为AVX-512
+inline int __simd_detect()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return 2;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+      __builtin_cpu_supports("popcnt"))
+    return 1;
+  return 0;
+}
+
+inline int __simd_level()
+{
+  static const int level = jan::__simd_detect();
+  return level;
+}
+
+/**
+ * @brief 按本机支持的指令集选出最宽的一组核心
+ *
+ * @tparam T
+ * @return __simd_kernel_table<T>
+ */
+template <typename T> __simd_kernel_table<T> __simd_select()
+{
+  switch (jan::__simd_level())
+  {
+  case 2:
+    return jan::__simd_make_table<__simd_avx512, __avx512_ops<T>>("avx512");
+  case 1:
+    return jan::__simd_make_table<__simd_avx2, __avx2_ops<T>>("avx2");
+  default:
+    return jan::__simd_make_table<__simd_sse2, __sse2_ops<T>>("sse2");
+  }
+}
+
+//第一次调用时选择, 之后直接返回
+template <typename T> inline const __simd_kernel_table<T> &__simd_table()
+{
+  static const __simd_kernel_table<T> table = jan::__simd_select<T>();
+  return table;
+}
+
+//拷贝和填充的核心, 与元素类型无关
+struct __simd_mem_table {
+  void (*stream_copy)(char *, const char *, size_t);
+  void (*fill)(char *, size_t, const char *, bool);
+};
+
+inline __simd_mem_table __simd_mem_select()
+{
+  __simd_mem_table ret;
+  switch (jan::__simd_level())
+  {
+  case 2:
+    ret.stream_copy = &__simd_avx512::stream_copy<__avx512_ops<int>>;
+    ret.fill = &__simd_avx512::fill<__avx512_ops<int>>;
+    break;
+  case 1:
+    ret.stream_copy = &__simd_avx2::stream_copy<__avx2_ops<int>>;
+    ret.fill = &__simd_avx2::fill<__avx2_ops<int>>;
+    break;
+  default:
+    ret.stream_copy = &__simd_sse2::stream_copy<__sse2_ops<int>>;
+    ret.fill = &__simd_sse2::fill<__sse2_ops<int>>;
+  }
+  return ret;
+}
+
+inline const __simd_mem_table &__simd_mem()
+{
+  static const __simd_mem_table table = jan::__simd_mem_select();
+  return table;
+}
+
+template <typename T> inline const T *__simd_find(const T *first, const T *last, T val)
+{
+  return jan::__simd_table<T>().find(first, last, val);
+}
+
+template <typename T> inline size_t __simd_count(const T *first, const T *last, T val)
+{
+  return jan::__simd_table<T>().count(first, last, val);
+}
+
+template <typename T> inline T __simd_sum(const T *first, const T *last)
+{
+  return jan::__simd_table<T>().sum(first, last);
+}
+
+template <typename T> inline T __simd_dot(const T *first1, const T *last1, const T *first2)
+{
+  return jan::__simd_table<T>().dot(first1, last1, first2);
+}
+
+/**
+ * @brief 用non-temporal写把src的n个字节拷贝到dst, 两个区间不能重叠
+ *
+ * @param dst
+ * @param src
+ * @param n
+ */
+inline void __simd_stream_copy(void *dst, const void *src, size_t n)
+{
+  jan::__simd_mem().stream_copy(static_cast<char *>(dst), static_cast<const char *>(src), n);
+}
+
+/**
+ * @brief 把64字节的pattern重复写满从dst开始的n个字节
+ *
+ * @param dst
+ * @param n
+ * @param pattern 第k个字节是要写到dst + k (mod 64)处的值
+ * @param stream 为true时使用non-temporal写, dst必须按64字节对齐
+ */
+inline void __simd_fill(void *dst, size_t n, const char *pattern, bool stream)
+{
+  jan::__simd_mem().fill(static_cast<char *>(dst), n, pattern, stream);
+}
+
+//两个严格递增的区间逐个比较求交集, 用于块比较之后剩下的部分
+template <typename T>
+inline T *__intersect_unique_scalar(const T *a, const T *a_end, const T *b, const T *b_end, T *out)
+{
+  while (a != a_end && b != b_end)
+  {
+    if (*a < *b)
+      ++a;
+    else if (*b < *a)
+      ++b;
+    else
+    {
+      *out++ = *a;
+      ++a;
+      ++b;
+    }
+  }
+  return out;
+}
+
+template <size_t N> struct __size_tag {
+};
+
+/**
+ * @brief 4x4的块比较求交集: 两边各取4个元素, 把b的块轮转3次与a的块逐个比较,
+ *        得到a的块中哪些元素出现在b的块里; 然后最大值较小的一块(相等时两块)前进
+ *        区间严格递增, 所以一个元素不会在两个块里重复命中
+ *
+ * @tparam T 4字节整数
+ * @return T* 写完后的out
+ */
+template <typename T>
+__JAN_SIMD_TARGET("sse2")
+T *__simd_intersect_unique(const T *a, const T *a_end, const T *b, const T *b_end, T *out, __size_tag<4>)
+{
+  while (a_end - a >= 4 && b_end - b >= 4)
+  {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+    __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                     _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+        _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                     _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+    for (unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(m)); mask; mask &= mask - 1)
+      *out++ = a[__builtin_ctz(mask)];
+    const T amax = a[3], bmax = b[3];
+    if (!(bmax < amax))
+      a += 4;
+    if (!(amax < bmax))
+      b += 4;
+  }
+  return jan::__intersect_unique_scalar(a, a_end, b, b_end, out);
+}
+
+//8字节整数的4x4块比较, 需要AVX2
+template <typename T>
+__JAN_SIMD_TARGET("avx2")
+T *__intersect_unique_avx2(const T *a, const T *a_end, const T *b, const T *b_end, T *out)
+{
+  while (a_end - a >= 4 && b_end - b >= 4)
+  {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+    __m256i m = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi64(va, vb),
+                        _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+        _mm256_or_si256(_mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                        _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+    for (unsigned mask = _mm256_movemask_pd(_mm256_castsi256_pd(m)); mask; mask &= mask - 1)
+      *out++ = a[__builtin_ctz(mask)];
+    const T amax = a[3], bmax = b[3];
+    if (!(bmax < amax))
+      a += 4;
+    if (!(amax < bmax))
+      b += 4;
+  }
+  return jan::__intersect_unique_scalar(a, a_end, b, b_end, out);
+}
+
+template <typename T>
+inline T *__simd_intersect_unique(const T *a, const T *a_end, const T *b, const T *b_end, T *out, __size_tag<8>)
+{
+  if (jan::__simd_level() >= 1)
+    return jan::__intersect_unique_avx2(a, a_end, b, b_end, out);
+  return jan::__intersect_unique_scalar(a, a_end, b, b_end, out);
+}
+
+//前缀和在向量之后剩下的部分, carry是之前所有元素与init之和
+template <typename T>
+inline T *__scan_scalar(const T *first, const T *last, T *res, T carry, bool exclusive)
+{
+  if (exclusive)
+    for (; first != last; ++first, ++res)
+    {
+      T x = *first;
+      *res = carry;
+      carry += x;
+    }
+  else
+    for (; first != last; ++first, ++res)
+    {
+      carry += *first;
+      *res = carry;
+    }
+  return res;
+}
+
+/**
+ * @brief 寄存器内的前缀和: 向量x做log2(lanes)次"整体左移若干个分量后与自己相加"
+ *        得到向量内的前缀和s, 写出s + carry; carry再加上s的最后一个分量
+ *        carry上的依赖链每个向量只有一次加法, 向量内的扫描可以与之重叠
+ *        exclusive时写出的是inclusive的结果减去x, 整数加减按补码回绕, 结果是精确的
+ *
+ * @tparam T 4字节整数
+ * @return T* 写完后的res
+ */
+template <typename T>
+__JAN_SIMD_TARGET("sse2")
+T *__scan_sse2(const T *first, const T *last, T *res, T init, bool exclusive, __size_tag<4>)
+{
+  __m128i carry = _mm_set1_epi32(static_cast<int>(init));
+  for (; last - first >= 4; first += 4, res += 4)
+  {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+    __m128i s = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    s = _mm_add_epi32(s, _mm_slli_si128(s, 8));
+    __m128i out = _mm_add_epi32(s, carry);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(res), exclusive ? _mm_sub_epi32(out, x) : out);
+    carry = _mm_add_epi32(carry, _mm_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3)));
+  }
+  init = static_cast<T>(_mm_cvtsi128_si32(carry));
+  return jan::__scan_scalar(first, last, res, init, exclusive);
+}
+
+template <typename T>
+__JAN_SIMD_TARGET("sse2")
+T *__scan_sse2(const T *first, const T *last, T *res, T init, bool exclusive, __size_tag<8>)
+{
+  __m128i carry = _mm_set1_epi64x(static_cast<long long>(init));
+  for (; last - first >= 2; first += 2, res += 2)
+  {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+    __m128i s = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    __m128i out = _mm_add_epi64(s, carry);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(res), exclusive ? _mm_sub_epi64(out, x) : out);
+    carry = _mm_add_epi64(carry, _mm_shuffle_epi32(s, _MM_SHUFFLE(3, 2, 3, 2)));
+  }
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(&init), carry);
+  return jan::__scan_scalar(first, last, res, init, exclusive);
+}
+
+//AVX2的移位不跨128位的两半, 两半各自扫描后把低半的最后一个分量加到高半
+template <typename T>
+__JAN_SIMD_TARGET("avx2")
+T *__scan_avx2(const T *first, const T *last, T *res, T init, bool exclusive, __size_tag<4>)
+{
+  const __m256i last_lane = _mm256_set1_epi32(7);
+  __m256i carry = _mm256_set1_epi32(static_cast<int>(init));
+  for (; last - first >= 8; first += 8, res += 8)
+  {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+    __m256i s = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    s = _mm256_add_epi32(s, _mm256_slli_si256(s, 8));
+    __m256i low = _mm256_shuffle_epi32(s, _MM_SHUFFLE(3, 3, 3, 3));
+    s = _mm256_add_epi32(s, _mm256_permute2x128_si256(low, low, 0x08));
+    __m256i out = _mm256_add_epi32(s, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(res), exclusive ? _mm256_sub_epi32(out, x) : out);
+    carry = _mm256_add_epi32(carry, _mm256_permutevar8x32_epi32(s, last_lane));
+  }
+  init = static_cast<T>(_mm_cvtsi128_si32(_mm256_castsi256_si128(carry)));
+  return jan::__scan_scalar(first, last, res, init, exclusive);
+}
+
+template <typename T>
+__JAN_SIMD_TARGET("avx2")
+T *__scan_avx2(const T *first, const T *last, T *res, T init, bool exclusive, __size_tag<8>)
+{
+  __m256i carry = _mm256_set1_epi64x(static_cast<long long>(init));
+  for (; last - first >= 4; first += 4, res += 4)
+  {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+    __m256i s = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+    __m256i low = _mm256_permute4x64_epi64(s, _MM_SHUFFLE(1, 1, 1, 1));
+    s = _mm256_add_epi64(s, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+    __m256i out = _mm256_add_epi64(s, carry);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(res), exclusive ? _mm256_sub_epi64(out, x) : out);
+    carry = _mm256_add_epi64(carry, _mm256_permute4x64_epi64(s, _MM_SHUFFLE(3, 3, 3, 3)));
+  }
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(&init), _mm256_castsi256_si128(carry));
+  return jan::__scan_scalar(first, last, res, init, exclusive);
+}
+
+/**
+ * @brief 4/8字节整数的前缀和, res[i] = init + first[0] + ... + first[i],
+ *        exclusive时不含first[i]; res可以等于first
+ *        AVX-512的跨128位修正需要更多的置换, 扫描又受内存带宽限制, 所以最多用到AVX2
+ *
+ * @tparam T
+ * @return T* 写完后的res
+ */
+template <typename T>
+inline T *__simd_scan(const T *first, const T *last, T *res, T init, bool exclusive)
+{
+  if (jan::__simd_level() >= 1)
+    return jan::__scan_avx2(first, last, res, init, exclusive, __size_tag<sizeof(T)>());
+  return jan::__scan_sse2(first, last, res, init, exclusive, __size_tag<sizeof(T)>());
+}
+
+/**
+ * @brief 每次比较16个字节, cmpeq之后movemask, 掩码不全为1时最低的0位就是第一个不同的字节
+ *
+ * @param a
+ * @param b
+ * @param n 字节数
+ * @return size_t 第一个不同的字节的位置, 全部相同时为n
+ */
+__JAN_SIMD_TARGET("sse2")
+inline size_t __mismatch_bytes_sse2(const char *a, const char *b, size_t n)
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    unsigned diff = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^ 0xFFFFu;
+    if (diff != 0)
+      return i + __builtin_ctz(diff);
+  }
+  for (; i < n && a[i] == b[i]; ++i)
+    ;
+  return i;
+}
+
+//每次比较64个字节, 两个32字节块的比较结果先合并, 有不同时再分别看两块
+__JAN_SIMD_TARGET("avx2")
+inline size_t __mismatch_bytes_avx2(const char *a, const char *b, size_t n)
+{
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64)
+  {
+    __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+    __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 32)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 32)));
+    if (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(e0, e1))) != 0xFFFFFFFFu)
+    {
+      unsigned diff = ~static_cast<unsigned>(_mm256_movemask_epi8(e0));
+      if (diff != 0)
+        return i + __builtin_ctz(diff);
+      return i + 32 + __builtin_ctz(~static_cast<unsigned>(_mm256_movemask_epi8(e1)));
+    }
+  }
+  if (i + 32 <= n)
+  {
+    unsigned diff = ~static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)))));
+    if (diff != 0)
+      return i + __builtin_ctz(diff);
+    i += 32;
+  }
+  return i + jan::__mismatch_bytes_sse2(a + i, b + i, n - i);
+}
+
+/**
+ * @brief first1和first2开始的n个整数中第一个不相等的位置, 全部相等时为n
+ *        整数相等就是字节相等, 找到第一个不同的字节后除以sizeof(T)
+ *        比较受内存带宽限制, AVX-512的64字节块没有明显收益, 所以最多用到AVX2
+ *
+ * @tparam T
+ * @param first1
+ * @param first2
+ * @param n
+ * @return size_t
+ */
+template <typename T> inline size_t __simd_mismatch(const T *first1, const T *first2, size_t n)
+{
+  const char *a = reinterpret_cast<const char *>(first1), *b = reinterpret_cast<const char *>(first2);
+  const size_t bytes = n * sizeof(T);
+  const size_t off = jan::__simd_level() >= 1 ? jan::__mismatch_bytes_avx2(a, b, bytes)
+                                              : jan::__mismatch_bytes_sse2(a, b, bytes);
+  return off / sizeof(T);
+}
+
+//结点内计数在向量之后剩下的部分
+template <typename T> inline size_t __rank_scalar(const T *p, size_t n, T val, bool upper)
+{
+  size_t cnt = 0;
+  for (size_t i = 0; i < n; ++i)
+    cnt += upper ? !(val < p[i]) : p[i] < val;
+  return cnt;
+}
+
+//有符号比较之前与它异或: 无符号数翻转最高位后按有符号数比较, 大小关系不变
+template <typename T> inline T __rank_bias()
+{
+  return static_cast<T>(-1) < static_cast<T>(0) ? T(0) : static_cast<T>(1ULL << (sizeof(T) * 8 - 1));
+}
+
+/**
+ * @brief p开始的n个整数中小于val(upper时为不大于val)的个数
+ *        每个向量cmpgt之后movemask, 置位数累加; upper时数的是大于val的个数, 最后用n减去
+ *
+ * @tparam T 4字节整数
+ * @return size_t
+ */
+template <typename T>
+__JAN_SIMD_TARGET("sse2")
+size_t __rank_sse2(const T *p, size_t n, T val, bool upper, __size_tag<4>)
+{
+  const __m128i bias = _mm_set1_epi32(static_cast<int>(jan::__rank_bias<T>()));
+  const __m128i v = _mm_xor_si128(_mm_set1_epi32(static_cast<int>(val)), bias);
+  size_t cnt = 0, i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i)), bias);
+    __m128i m = upper ? _mm_cmpgt_epi32(x, v) : _mm_cmpgt_epi32(v, x);
+    cnt += jan::__popcount4(_mm_movemask_ps(_mm_castsi128_ps(m)));
+  }
+  if (upper)
+    cnt = i - cnt;
+  return cnt + jan::__rank_scalar(p + i, n - i, val, upper);
+}
+
+//SSE2没有64位的cmpgt
+template <typename T>
+inline size_t __rank_sse2(const T *p, size_t n, T val, bool upper, __size_tag<8>)
+{
+  return jan::__rank_scalar(p, n, val, upper);
+}
+
+template <typename T>
+__JAN_SIMD_TARGET("avx2,fma,popcnt")
+size_t __rank_avx2(const T *p, size_t n, T val, bool upper, __size_tag<4>)
+{
+  const __m256i bias = _mm256_set1_epi32(static_cast<int>(jan::__rank_bias<T>()));
+  const __m256i v = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(val)), bias);
+  size_t cnt = 0, i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)), bias);
+    __m256i m = upper ? _mm256_cmpgt_epi32(x, v) : _mm256_cmpgt_epi32(v, x);
+    cnt += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m)));
+  }
+  if (upper)
+    cnt = i - cnt;
+  return cnt + jan::__rank_scalar(p + i, n - i, val, upper);
+}
+
+template <typename T>
+__JAN_SIMD_TARGET("avx2,fma,popcnt")
+size_t __rank_avx2(const T *p, size_t n, T val, bool upper, __size_tag<8>)
+{
+  const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(jan::__rank_bias<T>()));
+  const __m256i v = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(val)), bias);
+  size_t cnt = 0, i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i)), bias);
+    __m256i m = upper ? _mm256_cmpgt_epi64(x, v) : _mm256_cmpgt_epi64(v, x);
+    cnt += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+  }
+  if (upper)
+    cnt = i - cnt;
+  return cnt + jan::__rank_scalar(p + i, n - i, val, upper);
+}
+
+/**
+ * @brief 静态B+树结点内的计数: p开始的n个4/8字节整数中小于val(upper时为不大于val)的个数
+ *        一个结点通常只有一个缓存行, 两个AVX2向量就能比较完, 所以最多用到AVX2
+ *
+ * @tparam T
+ * @return size_t
+ */
+template <typename T> inline size_t __simd_rank(const T *p, size_t n, T val, bool upper)
+{
+  if (jan::__simd_level() >= 1)
+    return jan::__rank_avx2(p, n, val, upper, __size_tag<sizeof(T)>());
+  return jan::__rank_sse2(p, n, val, upper, __size_tag<sizeof(T)>());
+}
+
+#endif // __JAN_SIMD_X86
+
+} // namespace jan
+
+#endif
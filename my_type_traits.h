@@ -5,54 +5,63 @@
 #ifndef MYSTL__MY_TYPE_TRAITS_H_
 #define MYSTL__MY_TYPE_TRAITS_H_
 
+#include <type_traits>
+
 namespace jan{
 	struct _true_type { };
 	struct _false_type{ };
-#define A_BUILD_IN_TYPE(Type) 								\
-    template<> struct type_traits<Type>{        			\
-      typedef _true_type has_trivial_default_constructor; \
-   		typedef _true_type has_trivial_copy_constructor;  	\
-   		typedef _true_type has_trivial_assignment_operator;\
-   		typedef _true_type has_trivial_destructor;  		\
-   		typedef _true_type is_POD_type;                 	\
-	};                         						   		\
 
+	//把编译期的bool转成_true_type/_false_type, 算法按它们重载分派
+	template <bool B> struct __bool_type { typedef _true_type type; };
+	template <> struct __bool_type<false> { typedef _false_type type; };
+
+	/**
+	 * @brief 由编译器给出各项操作是否平凡(trivial), 不再手工列举内置类型
+	 *        float, bool, 枚举, char16_t, 指针以及平凡可拷贝的自定义结构体都能走memmove/跳过析构的快速路径
+	 *        has_trivial_assignment_operator和is_POD_type决定能否按字节拷贝, 所以都要求平凡可拷贝;
+	 *        is_POD_type还要求拷贝构造和赋值都平凡(可以用赋值代替在未初始化内存上的构造),
+	 *        不要求默认构造平凡, 带默认成员初始值的结构体也可以按字节拷贝
+	 *        需要时仍然可以为自己的类型特化type_traits
+	 * 
+	 * @tparam T 
+	 */
 	template <typename T>
 	struct type_traits{
-		typedef _false_type has_trivial_default_constructor;
-		typedef _false_type has_trivial_copy_constructor;
-		typedef _false_type has_trivial_assignment_operator;
-		typedef _false_type has_trivial_destructor;
-		typedef _false_type is_POD_type;
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 5
+		//GCC 5之前的libstdc++没有is_trivially_*, 直接用编译器内建的判断
+		typedef typename __bool_type<__has_trivial_constructor(T)>::type has_trivial_default_constructor;
+		typedef typename __bool_type<__has_trivial_copy(T)>::type has_trivial_copy_constructor;
+		typedef typename __bool_type<__has_trivial_assign(T)>::type has_trivial_assignment_operator;
+		typedef typename __bool_type<__has_trivial_destructor(T)>::type has_trivial_destructor;
+		typedef typename __bool_type<__has_trivial_copy(T) && __has_trivial_assign(T)
+									 && __has_trivial_destructor(T)>::type is_POD_type;
+#else
+		typedef typename __bool_type<std::is_trivially_default_constructible<T>::value>::type
+			has_trivial_default_constructor;
+		typedef typename __bool_type<std::is_trivially_copy_constructible<T>::value>::type
+			has_trivial_copy_constructor;
+		typedef typename __bool_type<std::is_trivially_copy_assignable<T>::value
+									 && std::is_trivially_copyable<T>::value>::type has_trivial_assignment_operator;
+		typedef typename __bool_type<std::is_trivially_destructible<T>::value>::type has_trivial_destructor;
+		typedef typename __bool_type<std::is_trivially_copyable<T>::value
+									 && std::is_trivially_copy_constructible<T>::value
+									 && std::is_trivially_copy_assignable<T>::value>::type is_POD_type;
+#endif
 	};
 
+	/**
+	 * @brief 是否为整数类型, integral为_true_type或_false_type, 用于算法的分派(如auto_sort)
+	 *        包括char16_t, char32_t等所有整数类型, 但不包括bool
+	 * 
+	 * @tparam T 
+	 */
 	template <typename T>
-	struct type_traits<T*>
+	struct is_integer
 	{
-		typedef _true_type has_trivial_default_constructor;
-		typedef _true_type has_trivial_copy_constructor;
-		typedef _true_type has_trivial_assignment_operator;
-		typedef _true_type has_trivial_destructor;
-		typedef _true_type is_POD_type;
+		typedef typename __bool_type<std::is_integral<T>::value
+									 && !std::is_same<typename std::remove_cv<T>::type, bool>::value>::type integral;
 	};
 
-	
-	//int8 16 32 ..._t均为typedef
-	A_BUILD_IN_TYPE(wchar_t);
-	A_BUILD_IN_TYPE(int);
-	A_BUILD_IN_TYPE(double);
-	A_BUILD_IN_TYPE(long);
-	A_BUILD_IN_TYPE(char);
-	A_BUILD_IN_TYPE(signed char );
-	A_BUILD_IN_TYPE(unsigned char );
-	A_BUILD_IN_TYPE(unsigned int);
-	A_BUILD_IN_TYPE(long long int);
-	A_BUILD_IN_TYPE(short)
-	A_BUILD_IN_TYPE(unsigned short );
-	A_BUILD_IN_TYPE(unsigned long);
-	A_BUILD_IN_TYPE(long double);
-
-
 }
 
 #endif//MYSTL__MY_TYPE_TRAITS_H_
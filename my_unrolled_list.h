@@ -0,0 +1,416 @@
+#ifndef __MY_UNROLLED_LIST_H_
+#define __MY_UNROLLED_LIST_H_
+
+#include "my_allocator.h"
+#include "my_iterator.h"
+#include "memory.h"
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+namespace jan {
+
+/**
+ * @brief 展开链表节点的链接部分, 链表头只需要这一部分，不会为它分配元素空间
+ *
+ */
+struct _unrolled_node_base {
+  _unrolled_node_base *_pre;
+  _unrolled_node_base *_next;
+};
+
+/**
+ * @brief 计算每个节点能放多少个元素, 用户指定了K就用K,
+ *        否则与deque的缓冲区一样，让一个节点的元素占512字节左右，但至少放2个
+ *
+ * @tparam T
+ * @tparam K
+ */
+template <typename T, size_t K> struct __unrolled_node_capacity {
+  static const size_t value =
+      K != 0 ? K : (sizeof(T) < 256 ? 512 / sizeof(T) : 2);
+  static_assert(value >= 2, "an unrolled_list node must hold at least 2 elements");
+};
+
+/**
+ * @brief 展开链表的节点, 连续存放最多capacity个元素, [0,_count)是已构造的元素
+ *
+ * @tparam T
+ * @tparam K
+ */
+template <typename T, size_t K> struct _unrolled_node : _unrolled_node_base {
+  static const size_t capacity = __unrolled_node_capacity<T, K>::value;
+  size_t _count;
+  typename std::aligned_storage<sizeof(T) * capacity, alignof(T)>::type _storage;
+  T *data() { return reinterpret_cast<T *>(&_storage); }
+};
+
+/**
+ * @brief 展开链表的迭代器, 与_list_iterator一样是双向迭代器，
+ *        由节点指针和节点内的下标组成, end()是(链表头, 0)
+ *
+ * @tparam T
+ * @tparam K
+ */
+template <typename T, size_t K> struct _unrolled_list_iterator {
+  using value_type = T;
+  using pointer = T *;
+  using reference = T &;
+  using size_type = size_t;
+  using iterator_category = bidirectional_iterator_tag;
+  using self = _unrolled_list_iterator<T, K>;
+  using node_type = _unrolled_node<T, K>;
+  using difference_type = ptrdiff_t;
+  T &operator*() { return node()->data()[_idx]; }
+  T *operator->() { return node()->data() + _idx; }
+  bool operator==(const self &rhs) { return _node == rhs._node && _idx == rhs._idx; }
+  bool operator!=(const self &rhs) { return !(*this == rhs); }
+  self &operator++() {
+    if (++_idx == node()->_count) {
+      _node = _node->_next;
+      _idx = 0;
+    }
+    return *this;
+  }
+  self operator++(int) {
+    auto ret = *this;
+    ++*this;
+    return ret;
+  }
+  self &operator--() {
+    if (_idx == 0) {
+      _node = _node->_pre;
+      _idx = node()->_count - 1;
+    } else
+      --_idx;
+    return *this;
+  }
+  self operator--(int) {
+    auto ret = *this;
+    --*this;
+    return ret;
+  }
+  node_type *node() const { return static_cast<node_type *>(_node); }
+  _unrolled_node_base *_node;
+  size_type _idx;
+  explicit _unrolled_list_iterator(_unrolled_node_base *node = nullptr,
+                                   size_type idx = 0)
+      : _node(node), _idx(idx) {}
+};
+
+/**
+ * @brief 展开链表, 每个节点连续存放多个元素，遍历时大部分时间在连续内存上移动
+ *        节点满了就对半分裂, 删除后不足半满就尝试与后继节点合并
+ *        splice以节点为单位，只需要在pos处至多分裂一个节点
+ *
+ * @tparam T
+ * @tparam K 每个节点最多容纳的元素个数，0表示自动计算
+ * @tparam Alloc
+ */
+template <typename T, size_t K = 0, typename Alloc = jan::alloc>
+class unrolled_list {
+private:
+  using node_base = _unrolled_node_base;
+  using node_type = _unrolled_node<T, K>;
+  static const size_t node_capacity = node_type::capacity;
+
+public:
+  using value_type = T;
+  using iterator = _unrolled_list_iterator<T, K>;
+  using size_type = size_t;
+  iterator begin() const { return iterator(_header._next); }
+  iterator end() const { return iterator(const_cast<node_base *>(&_header)); }
+  bool empty() const { return _size == 0; }
+  size_type size() const { return _size; }
+  T &front() { return *begin(); }
+  T &back() { return *(--end()); }
+
+  iterator insert(iterator pos, const T &val);
+  void push_front(const T &val) { insert(begin(), val); }
+  void push_back(const T &val);
+
+  iterator erase(iterator pos);
+  void pop_front() { erase(begin()); }
+  void pop_back() { auto tmp = end(); erase(--tmp); }
+
+  void clear();
+  void splice(iterator pos, unrolled_list &x);
+
+protected:
+  using node_alloc = alloc_adapter<node_type, Alloc>;
+  node_type *creat_node() {
+    node_type *ret = node_alloc::allocate(1);
+    ret->_count = 0;
+    return ret;
+  }
+  void put_node(node_type *p) { node_alloc::deallocate(p, 1); }
+  //把node接到pos之前
+  static void link_before(node_base *pos, node_base *node) {
+    node->_pre = pos->_pre;
+    node->_next = pos;
+    pos->_pre->_next = node;
+    pos->_pre = node;
+  }
+  static void unlink(node_base *node) {
+    node->_pre->_next = node->_next;
+    node->_next->_pre = node->_pre;
+  }
+  node_type *split(node_type *node, size_type at);
+  void init_empty() {
+    _header._pre = &_header;
+    _header._next = &_header;
+    _size = 0;
+  }
+
+  //链表头, 只有两个指针, 空链表不需要分配任何内存
+  node_base _header;
+  size_type _size;
+
+public:
+  unrolled_list() { init_empty(); }
+
+  unrolled_list(const std::initializer_list<T> &ls) : unrolled_list() {
+    for (auto it = ls.begin(); it != ls.end(); ++it)
+      push_back(*it);
+  }
+
+  unrolled_list(const unrolled_list &rhs) : unrolled_list() {
+    for (auto it = rhs.begin(); it != rhs.end(); ++it)
+      push_back(*it);
+  }
+
+  /**
+   * @brief 移动构造，链表头是成员，所以要让首尾节点重新指向新的链表头
+   *
+   * @param rhs
+   */
+  unrolled_list(unrolled_list &&rhs) {
+    init_empty();
+    splice(end(), rhs);
+  }
+
+  unrolled_list &operator=(const unrolled_list &rhs) {
+    if (this != &rhs) {
+      clear();
+      for (auto it = rhs.begin(); it != rhs.end(); ++it)
+        push_back(*it);
+    }
+    return *this;
+  }
+
+  unrolled_list &operator=(unrolled_list &&rhs) {
+    if (this != &rhs) {
+      clear();
+      splice(end(), rhs);
+    }
+    return *this;
+  }
+
+  ~unrolled_list() { clear(); }
+};
+
+/**
+ * @brief 把node中[at,_count)的元素移到一个新建的后继节点里, 返回新节点
+ *
+ * @tparam T
+ * @tparam K
+ * @tparam Alloc
+ * @param node
+ * @param at
+ * @return node_type*
+ */
+template <typename T, size_t K, typename Alloc>
+typename unrolled_list<T, K, Alloc>::node_type *
+unrolled_list<T, K, Alloc>::split(node_type *node, size_type at) {
+  node_type *next = creat_node();
+  T *src = node->data();
+  T *dst = next->data();
+  //POD类型的搬迁是一次memmove, 析构什么也不做
+  try {
+    jan::uninitialized_move(src + at, src + node->_count, dst);
+  } catch (...) {
+    //uninitialized_move已经析构了构造好的部分, 只需要还回节点
+    put_node(next);
+    throw;
+  }
+  jan::destroy(src + at, src + node->_count);
+  next->_count = node->_count - at;
+  node->_count = at;
+  link_before(node->_next, next);
+  return next;
+}
+
+/**
+ * @brief 在尾部添加一个元素，最后一个节点满了才分配新节点
+ *
+ * @tparam T
+ * @tparam K
+ * @tparam Alloc
+ * @param val
+ */
+template <typename T, size_t K, typename Alloc>
+void unrolled_list<T, K, Alloc>::push_back(const T &val) {
+  node_type *last = static_cast<node_type *>(_header._pre);
+  if (_header._pre == &_header || last->_count == node_capacity) {
+    last = creat_node();
+    try {
+      jan::construct(last->data(), val);
+    } catch (...) {
+      put_node(last);
+      throw;
+    }
+    link_before(&_header, last);
+  } else
+    jan::construct(last->data() + last->_count, val);
+  ++last->_count;
+  ++_size;
+}
+
+/**
+ * @brief 在pos之前插入一个元素, 返回指向新元素的迭代器
+ *        pos位于节点开头而前一个节点还有空位时直接追加到前一个节点,
+ *        当前节点满了就先对半分裂
+ *
+ * @tparam T
+ * @tparam K
+ * @tparam Alloc
+ * @param pos
+ * @param val
+ * @return unrolled_list<T, K, Alloc>::iterator
+ */
+template <typename T, size_t K, typename Alloc>
+typename unrolled_list<T, K, Alloc>::iterator
+unrolled_list<T, K, Alloc>::insert(iterator pos, const T &val) {
+  node_base *pre = pos._node->_pre;
+  if (pos._idx == 0 && pre != &_header &&
+      static_cast<node_type *>(pre)->_count < node_capacity) {
+    node_type *node = static_cast<node_type *>(pre);
+    jan::construct(node->data() + node->_count, val);
+    ++_size;
+    return iterator(node, node->_count++);
+  }
+  if (pos._node == &_header) {
+    push_back(val);
+    return iterator(_header._pre, static_cast<node_type *>(_header._pre)->_count - 1);
+  }
+  T tmp(val);
+  node_type *node = pos.node();
+  size_type idx = pos._idx;
+  if (node->_count == node_capacity) {
+    const size_type half = node_capacity / 2;
+    node_type *next = split(node, half);
+    if (idx > half) {
+      node = next;
+      idx -= half;
+    }
+  }
+  T *data = node->data();
+  if (idx == node->_count)
+    jan::construct(data + idx, std::move(tmp));
+  else {
+    jan::construct(data + node->_count, std::move(data[node->_count - 1]));
+    for (size_type i = node->_count - 1; i > idx; --i)
+      data[i] = std::move(data[i - 1]);
+    data[idx] = std::move(tmp);
+  }
+  ++node->_count;
+  ++_size;
+  return iterator(node, idx);
+}
+
+/**
+ * @brief 删除pos指向的元素，返回其后继, 如果为空链表，则抛出一个logic_error
+ *        节点空了就释放, 不足半满并且能与后继节点放进一个节点时就合并
+ *
+ * @tparam T
+ * @tparam K
+ * @tparam Alloc
+ * @param pos
+ * @return unrolled_list<T, K, Alloc>::iterator
+ */
+template <typename T, size_t K, typename Alloc>
+typename unrolled_list<T, K, Alloc>::iterator
+unrolled_list<T, K, Alloc>::erase(iterator pos) {
+  if (empty())
+    throw std::logic_error("unrolled_list is empty");
+  node_type *node = pos.node();
+  const size_type idx = pos._idx;
+  T *data = node->data();
+  for (size_type i = idx + 1; i < node->_count; ++i)
+    data[i - 1] = std::move(data[i]);
+  jan::destroy(data + --node->_count);
+  --_size;
+
+  node_base *next = node->_next;
+  if (node->_count == 0) {
+    unlink(node);
+    put_node(node);
+    return iterator(next);
+  }
+  if (node->_count < node_capacity / 2 && next != &_header) {
+    node_type *succ = static_cast<node_type *>(next);
+    if (node->_count + succ->_count <= node_capacity) {
+      T *src = succ->data();
+      jan::uninitialized_move(src, src + succ->_count, data + node->_count);
+      jan::destroy(src, src + succ->_count);
+      node->_count += succ->_count;
+      unlink(succ);
+      put_node(succ);
+    }
+  }
+  if (idx == node->_count)
+    return iterator(node->_next);
+  return iterator(node, idx);
+}
+
+/**
+ * @brief 将x拼接在pos之前, pos不在节点开头时先在pos处分裂节点，
+ *        然后整串节点O(1)地接进来
+ *
+ * @tparam T
+ * @tparam K
+ * @tparam Alloc
+ * @param pos
+ * @param x
+ */
+template <typename T, size_t K, typename Alloc>
+void unrolled_list<T, K, Alloc>::splice(iterator pos, unrolled_list &x) {
+  if (x.empty() || &x == this)
+    return;
+  node_base *at = pos._node;
+  if (pos._idx != 0)
+    at = split(pos.node(), pos._idx);
+  node_base *first = x._header._next;
+  node_base *last = x._header._pre;
+  first->_pre = at->_pre;
+  at->_pre->_next = first;
+  last->_next = at;
+  at->_pre = last;
+  _size += x._size;
+  x.init_empty();
+}
+
+/**
+ * @brief 析构所有元素并释放所有节点
+ *
+ * @tparam T
+ * @tparam K
+ * @tparam Alloc
+ */
+template <typename T, size_t K, typename Alloc>
+void unrolled_list<T, K, Alloc>::clear() {
+  node_base *cur = _header._next;
+  while (cur != &_header) {
+    node_base *next = cur->_next;
+    node_type *node = static_cast<node_type *>(cur);
+    jan::destroy(node->data(), node->data() + node->_count);
+    put_node(node);
+    cur = next;
+  }
+  init_empty();
+}
+
+} // namespace jan
+
+#endif
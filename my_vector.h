@@ -14,6 +14,7 @@
 #include <initializer_list>
 #include <ios>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 namespace jan{
@@ -42,16 +43,23 @@ namespace jan{
     size_type capacity() const { return static_cast<size_type>(the_end-begin()); }
     bool empty() const { return begin() == end(); }
     reference operator[](size_type index) { return *(start + index); }
+    const T & operator[](size_type index) const { return *(start + index); }
     reference front() const { return *begin(); }
     reference back() const { return  *(end()-1); }
     vector() : start(nullptr), finish(nullptr), the_end(nullptr)
     { }
     vector(size_type n, const T & val) {
-      fill_initialized(n, val);
+      fill_initialized(execution::seq, n, val);
+    }
+    //带执行策略构造n个val, 例如vector(jan::execution::par, n, val)在线程池上并行构造
+    template <typename Policy,
+              typename = typename std::enable_if<is_execution_policy<Policy>::value>::type>
+    vector(const Policy & policy, size_type n, const T & val) {
+      fill_initialized(policy, n, val);
     }
     vector(const vector<T> & rhs){
       start = data_allocator::allocate(rhs.capacity());
-      finish = uninitialized_copy(rhs.begin(), rhs.end(), begin());
+      finish = jan::uninitialized_copy(rhs.begin(), rhs.end(), begin());
       the_end = start + rhs.capacity();
     }
     vector(const std::initializer_list<T> init_ls){
@@ -73,6 +81,9 @@ namespace jan{
     iterator erase(iterator pos);
     iterator erase(iterator first, iterator last);
     void resize(size_type n, const T & val = T{});
+    void reserve(size_type n);
+    template <typename ForwardIter>
+    void append(ForwardIter first, ForwardIter last);
     void clear();
     iterator insert(iterator pos, size_type n, const T & val);
     iterator insert(iterator pos, const T & val);
@@ -86,8 +97,10 @@ namespace jan{
     iterator start, finish, the_end;
     void deallocate();
     using data_allocator = jan::alloc_adapter<T, Alloc>;
-    iterator alloc_and_fill(size_type n, const T & val);
-    void fill_initialized(size_type n, const T & val);
+    template <typename Policy>
+    iterator alloc_and_fill(const Policy & policy, size_type n, const T & val);
+    template <typename Policy>
+    void fill_initialized(const Policy & policy, size_type n, const T & val);
     size_type get_new_size() const { return size() == 0 ? 1 : 2 * size(); }
   };
 
@@ -102,20 +115,28 @@ namespace jan{
     }
     else
     {
-      auto new_start = data_allocator::allocate(get_new_size());
+      const size_type new_size = get_new_size();
+      auto new_start = data_allocator::allocate(new_size);
       auto new_finish = new_start;
+      auto slot = new_start + size();
+      bool built = false;
       try {
-        new_finish = uninitialized_copy(begin(), end(), new_start);
+        //先构造新元素, args可能引用容器中的元素, 之后才能移走它们
+        new(slot)T(std::forward<Args>(args)...);
+        built = true;
+        new_finish = jan::uninitialized_move_if_noexcept(begin(), end(), new_start);
+        ++new_finish;
       } catch (...) {
-        destroy(new_start,new_finish);
-        data_allocator::deallocate(new_start,size());
+        if (built)
+          jan::destroy(slot);
+        data_allocator::deallocate(new_start,new_size);
         throw;
       }
+      jan::destroy(begin(),end());
+      deallocate();
       start = new_start;
       finish = new_finish;
-      the_end = new_start + size();
-      new(finish)T(std::forward<Args>(args)...);
-      ++finish;
+      the_end = new_start + new_size;
     }
   }
 
@@ -146,8 +167,24 @@ namespace jan{
       throw std::invalid_argument("n is less zero");
     if (size() + n <= capacity())
     {
-      copy(pos,end(),pos+n);
-      fill_n(pos,n,val);
+      const T tmp = val; //val可能就是容器中的元素
+      const size_type elems_after = end() - pos;
+      iterator old_finish = finish;
+      if (elems_after > n)
+      {
+        //最后n个元素移动到未初始化的空间, 其余的从后往前挪n位
+        jan::uninitialized_move(finish - n, finish, finish);
+        finish += n;
+        for (iterator src = old_finish - n, dst = old_finish; src != pos;)
+          *--dst = std::move(*--src);
+        jan::fill_n(pos, n, tmp);
+      }
+      else
+      {
+        finish = jan::uninitialized_fill_n(finish, n - elems_after, tmp);
+        finish = jan::uninitialized_move(pos, old_finish, finish);
+        jan::fill(pos, old_finish, tmp);
+      }
       return pos;
     }
     else
@@ -155,22 +192,32 @@ namespace jan{
       auto before_idx = pos - start;
       auto old_size = size();
       size_type new_size = old_size == 0 ? 1 : 2 * size();
+      if (new_size < old_size + n)
+        new_size = old_size + n;
       auto new_start = data_allocator::allocate(new_size);
       auto new_finish = new_start;
+      auto slot = new_start + before_idx;
+      bool built = false;
       try {
-        new_finish = uninitialized_copy(begin(), pos, new_start);
-        new_finish = uninitialized_fill_n(new_finish,n,val);
-        new_finish = uninitialized_copy(pos,end(),new_finish);
+        //先填充新元素, val可能引用容器中的元素
+        jan::uninitialized_fill_n(slot,n,val);
+        built = true;
+        new_finish = jan::uninitialized_move_if_noexcept(begin(), pos, new_start);
+        new_finish += n;
+        new_finish = jan::uninitialized_move_if_noexcept(pos,end(),new_finish);
       } catch (...) {
-        destroy(new_start,new_finish);
-        deallocate();
+        if (new_finish != new_start)
+          jan::destroy(new_start,new_finish);
+        else if (built)
+          jan::destroy(slot,slot + n);
+        data_allocator::deallocate(new_start,new_size);
         throw;
       }
-      destroy(begin(),end());
+      jan::destroy(begin(),end());
       deallocate();
       start = new_start;
       finish = start + n + old_size;
-      the_end = start + size();
+      the_end = start + new_size;
       return start + before_idx;
     }
   }
@@ -210,9 +257,9 @@ namespace jan{
     if(pos < begin() || pos >= end())
       throw std::out_of_range("pos out of range");
     if(pos != end() - 1)
-      copy(pos + 1, end(), pos);
+      jan::copy(pos + 1, end(), pos);
     --finish;
-    destroy(finish);
+    jan::destroy(finish);
     return pos;
   }
 
@@ -231,12 +278,12 @@ namespace jan{
   {
     if(last != end())
     {
-      copy(last,end(),first);
-      destroy(last,end());
+      jan::copy(last,end(),first);
+      jan::destroy(last,end());
     }
     else  //last = end() it's [pos,end())]
     {
-      destroy(first,last);
+      jan::destroy(first,last);
     }
     finish -= (last - first);
     return first;
@@ -263,6 +310,57 @@ namespace jan{
      insert(end(),n - size(),val);
   }
 
+  /**
+   * @brief 把容量扩大到至少n, 原有元素搬到新空间(能安全移动时移动), n不超过当前容量时什么也不做
+   * 
+   * @tparam T 
+   * @tparam Alloc 
+   * @param n 
+   */
+  template <typename T, typename Alloc>
+  void vector<T,Alloc>::reserve(size_type n)
+  {
+    if (n <= capacity())
+      return;
+    iterator new_start = data_allocator::allocate(n);
+    iterator new_finish = new_start;
+    try {
+      new_finish = jan::uninitialized_move_if_noexcept(begin(), end(), new_start);
+    } catch (...) {
+      data_allocator::deallocate(new_start,n);
+      throw;
+    }
+    jan::destroy(begin(),end());
+    deallocate();
+    start = new_start;
+    finish = new_finish;
+    the_end = new_start + n;
+  }
+
+  /**
+   * @brief 把[first,last)整段追加到尾部, 空间不够时只重新分配一次(至少翻倍),
+   *        之后一次uninitialized_copy构造所有新元素, POD类型就是一次memmove
+   * 
+   * @tparam T 
+   * @tparam Alloc 
+   * @tparam ForwardIter 
+   * @param first 
+   * @param last 
+   */
+  template <typename T, typename Alloc>
+    template <typename ForwardIter>
+  void vector<T,Alloc>::append(ForwardIter first, ForwardIter last)
+  {
+    const size_type n = jan::distance(first, last);
+    if (size() + n > capacity())
+    {
+      size_type new_size = get_new_size();
+      if (new_size < size() + n)
+        new_size = size() + n;
+      reserve(new_size);
+    }
+    finish = jan::uninitialized_copy(first, last, finish);
+  }
 
   /**
    * @brief  在迭代器指向处插入一个元素, such as inster_after
@@ -279,8 +377,17 @@ namespace jan{
       //如果还有空间
       if(end() < the_end)
       {
-        copy(pos,end(),pos+1);
-        *pos = val;
+        if (pos == end())
+          jan::construct(finish,val);
+        else
+        {
+          const T tmp = val; //val可能就是容器中的元素
+          //最后一个元素移动到未初始化的空间, 其余的从后往前挪一位
+          jan::construct(finish,std::move(*(finish - 1)));
+          for (iterator dst = finish - 1; dst != pos; --dst)
+            *dst = std::move(*(dst - 1));
+          *pos = tmp;
+        }
         ++finish;
       } // 如果没有空间了
       else
@@ -288,18 +395,25 @@ namespace jan{
         const size_type old_size = size();
         const size_type new_size = old_size == 0 ? 1 : 2 * old_size;
         iterator new_start = data_allocator::allocate(new_size);
-        iterator new_finish;
+        iterator new_finish = new_start;
+        iterator slot = new_start + (pos - start);
+        bool built = false;
         try {
-          new_finish = uninitialized_copy(begin(), pos, new_start);
-          construct(new_finish,val);
+          //先构造新元素, val可能引用容器中的元素
+          jan::construct(slot,val);
+          built = true;
+          new_finish = jan::uninitialized_move_if_noexcept(begin(), pos, new_start);
           ++new_finish; //now new finish is pos
-          new_finish = uninitialized_copy(pos, finish, new_finish);
+          new_finish = jan::uninitialized_move_if_noexcept(pos, finish, new_finish);
         } catch (...) { 
-          destroy(new_start,new_finish);
+          if (new_finish != new_start)
+            jan::destroy(new_start,new_finish);
+          else if (built)
+            jan::destroy(slot);
           data_allocator::deallocate(new_start,new_size);
           throw;
         }
-        destroy(begin(),end());
+        jan::destroy(begin(),end());
         deallocate();
         start = new_start;
         finish = new_finish;
@@ -320,7 +434,7 @@ namespace jan{
   inline void vector<T,Alloc>::push_back(const T & val)
   {
     if(end() < the_end){
-      construct(finish++,val);
+      jan::construct(finish++,val);
     }
     else
       insert_aux(end(),val);
@@ -336,11 +450,11 @@ namespace jan{
   inline void vector<T,Alloc>::pop_back()
   {
     --finish;
-    destroy(finish);
+    jan::destroy(finish);
   }
 
   /**
-   * @brief 回收全部内存空间
+   * @brief 回收全部内存空间, 归还的大小是容量而不是元素个数
    * 
    * @tparam T 
    * @tparam Alloc 
@@ -348,7 +462,7 @@ namespace jan{
   template <typename T, typename Alloc>
   inline void vector<T,Alloc>::deallocate()
   {
-    data_allocator::deallocate(begin(),size());
+    data_allocator::deallocate(begin(),capacity());
   }
 
   /**
@@ -360,28 +474,37 @@ namespace jan{
   template <typename T, typename Alloc>
   inline vector<T,Alloc>::~vector()
   {
-    if(start == finish)
+    if(start == nullptr)
       return;
-    destroy(start,finish);
+    jan::destroy(start,finish);
     deallocate();
   }
 
   
   /**
-   * @brief 开辟内存并填充元素
+   * @brief 开辟内存并按策略填充元素, 填充失败时释放内存再重新抛出异常
+   *        par时由线程池中的各个线程分块构造, 大数组的每一页由之后并行处理它的线程首次写入
    * 
    * @tparam T 
    * @tparam Alloc 
+   * @tparam Policy 
+   * @param policy 
    * @param n 
    * @param val 
    * @return vector<T,Alloc>::iterator 
    */
   template <typename T, typename Alloc>
+    template <typename Policy>
   typename vector<T,Alloc>::iterator
-  vector<T,Alloc>::alloc_and_fill(size_type n, const T & val)
+  vector<T,Alloc>::alloc_and_fill(const Policy & policy, size_type n, const T & val)
   {
     iterator res = data_allocator::allocate(n);
-    jan::uninitialized_fill_n(res,n,val);
+    try {
+      jan::uninitialized_fill_n(policy,res,n,val);
+    } catch (...) {
+      data_allocator::deallocate(res,n);
+      throw;
+    }
     return res;
   }
   
@@ -391,13 +514,16 @@ namespace jan{
    * 
    * @tparam T 
    * @tparam Alloc 
+   * @tparam Policy 
+   * @param policy 
    * @param n 
    * @param val 
    */
   template <typename T, typename Alloc>
-  void vector<T,Alloc>::fill_initialized(size_type n, const T & val)
+    template <typename Policy>
+  void vector<T,Alloc>::fill_initialized(const Policy & policy, size_type n, const T & val)
   {
-    start = alloc_and_fill(n, val);
+    start = alloc_and_fill(policy, n, val);
     finish = begin() + n;
     the_end = finish;
   }